@@ -0,0 +1,284 @@
+/**
+ * ARC implementation
+ */
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+#include "buffer/arc_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+/*
+ * frames use their frame id as slot and the id of the page they hold as key,
+ * plain integers (tests) are both
+ */
+static inline size_t SlotOf(Page *const &page) { return page->GetFrameId(); }
+static inline size_t SlotOf(const int &value) { return value; }
+static inline page_id_t KeyOf(Page *const &page) { return page->GetPageId(); }
+static inline page_id_t KeyOf(const int &value) { return value; }
+
+template <typename T>
+ARCReplacer<T>::ARCReplacer(size_t capacity)
+    : capacity_(capacity), target_(0), slots_(capacity), size_(0) {}
+
+template <typename T> ARCReplacer<T>::~ARCReplacer() {}
+
+/*
+ * Record an access to value, which is now pinned. This is where ARC adapts:
+ * a resident hit moves the frame to T2, a hit on a ghost list grows the list
+ * the page was evicted from, and a complete miss starts on T1
+ */
+template <typename T> void ARCReplacer<T>::RecordAccess(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Access(SlotOf(value), value);
+  Slot &s = slots_[SlotOf(value)];
+  if (s.evictable_) {
+    s.evictable_ = false;
+    size_--;
+  }
+}
+
+/*
+ * Make value a candidate for eviction. A value that was never accessed is
+ * accessed once now, so the replacer also works for callers that only use
+ * Insert/Erase
+ */
+template <typename T> void ARCReplacer<T>::Insert(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t slot = SlotOf(value);
+  if (slot >= slots_.size() || slots_[slot].key_ != KeyOf(value)) {
+    Access(slot, value);
+  }
+  Slot &s = slots_[slot];
+  if (!s.evictable_) {
+    s.evictable_ = true;
+    size_++;
+  }
+}
+
+/*
+ * Evict the least recent evictable frame of T1 if T1 is above its target,
+ * of T2 otherwise, falling back to the other list when every frame of the
+ * preferred one is pinned. The page id of the victim goes to the matching
+ * ghost list. Return false if the replacer is empty
+ */
+template <typename T> bool ARCReplacer<T>::Victim(T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (size_ == 0) {
+    return false;
+  }
+  if (!t1_.empty() && t1_.size() > target_) {
+    if (Evict(t1_, value) || Evict(t2_, value)) {
+      return true;
+    }
+  } else if (Evict(t2_, value) || Evict(t1_, value)) {
+    return true;
+  }
+  assert(0);
+  return false;
+}
+
+/*
+ * Remove value from the set of eviction candidates, it stays resident. If
+ * removal is successful, return true, otherwise return false
+ */
+template <typename T> bool ARCReplacer<T>::Erase(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t slot = SlotOf(value);
+  if (slot >= slots_.size() || !slots_[slot].evictable_) {
+    return false;
+  }
+  slots_[slot].evictable_ = false;
+  size_--;
+  return true;
+}
+
+/*
+ * Drop value from T1/T2 without a ghost, its page is gone from the frame
+ */
+template <typename T> void ARCReplacer<T>::Remove(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t slot = SlotOf(value);
+  if (slot >= slots_.size()) {
+    return;
+  }
+  Slot &s = slots_[slot];
+  if (s.evictable_) {
+    s.evictable_ = false;
+    size_--;
+  }
+  Unlink(s);
+  s.key_ = INVALID_PAGE_ID;
+}
+
+/*
+ * Undo Victim: the page leaves its ghost list and goes back to the cold end
+ * of the list it was evicted from, not evictable while it is pinned. A ghost
+ * trimmed meanwhile leaves no trace of the list, the page goes back to T1
+ */
+template <typename T> void ARCReplacer<T>::Restore(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t slot = SlotOf(value);
+  page_id_t key = KeyOf(value);
+  if (slot >= slots_.size() || slots_[slot].list_ != ListType::NONE) {
+    return;
+  }
+  Slot &s = slots_[slot];
+  std::list<size_t> *list = &t1_;
+  s.list_ = ListType::T1;
+  if (b1_index_.count(key) != 0) {
+    Forget(b1_, b1_index_, key);
+  } else if (b2_index_.count(key) != 0) {
+    Forget(b2_, b2_index_, key);
+    list = &t2_;
+    s.list_ = ListType::T2;
+  }
+  s.key_ = key;
+  s.value_ = value;
+  list->push_back(slot);
+  s.pos_ = std::prev(list->end());
+}
+
+template <typename T> size_t ARCReplacer<T>::Size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+template <typename T> size_t ARCReplacer<T>::GetTarget() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return target_;
+}
+
+/*
+ * Caller must hold mutex_
+ */
+template <typename T> void ARCReplacer<T>::Access(size_t slot, const T &value) {
+  if (slot >= slots_.size()) {
+    slots_.resize(slot + 1);
+    capacity_ = std::max(capacity_, slots_.size());
+  }
+  Slot &s = slots_[slot];
+  page_id_t key = KeyOf(value);
+  s.value_ = value;
+
+  if (s.key_ == key && s.list_ != ListType::NONE) {
+    // resident hit
+    Unlink(s);
+  } else {
+    // a frame that changed pages without going through Victim held a
+    // deleted page, which leaves no ghost
+    Unlink(s);
+    s.key_ = key;
+    if (b1_index_.count(key) != 0) {
+      size_t delta = std::max<size_t>(b2_.size() / b1_.size(), 1);
+      target_ = std::min(capacity_, target_ + delta);
+      Forget(b1_, b1_index_, key);
+    } else if (b2_index_.count(key) != 0) {
+      size_t delta = std::max<size_t>(b1_.size() / b2_.size(), 1);
+      target_ = target_ > delta ? target_ - delta : 0;
+      Forget(b2_, b2_index_, key);
+    } else {
+      // first sight of the page: T1
+      t1_.push_front(slot);
+      s.list_ = ListType::T1;
+      s.pos_ = t1_.begin();
+      return;
+    }
+  }
+  t2_.push_front(slot);
+  s.list_ = ListType::T2;
+  s.pos_ = t2_.begin();
+}
+
+template <typename T> void ARCReplacer<T>::Unlink(Slot &s) {
+  if (s.list_ == ListType::T1) {
+    t1_.erase(s.pos_);
+  } else if (s.list_ == ListType::T2) {
+    t2_.erase(s.pos_);
+  }
+  s.list_ = ListType::NONE;
+}
+
+/*
+ * Put key on a ghost list, keeping |T1| + |B1| and the whole directory
+ * within capacity and 2 * capacity
+ */
+template <typename T>
+void ARCReplacer<T>::Remember(
+    std::list<page_id_t> &ghost,
+    std::unordered_map<page_id_t, std::list<page_id_t>::iterator> &index,
+    page_id_t key) {
+  ghost.push_front(key);
+  index[key] = ghost.begin();
+  while (!b1_.empty() && t1_.size() + b1_.size() > capacity_) {
+    Forget(b1_, b1_index_, b1_.back());
+  }
+  while (!b2_.empty() &&
+         t1_.size() + t2_.size() + b1_.size() + b2_.size() > 2 * capacity_) {
+    Forget(b2_, b2_index_, b2_.back());
+  }
+}
+
+template <typename T>
+void ARCReplacer<T>::Forget(
+    std::list<page_id_t> &ghost,
+    std::unordered_map<page_id_t, std::list<page_id_t>::iterator> &index,
+    page_id_t key) {
+  auto it = index.find(key);
+  ghost.erase(it->second);
+  index.erase(it);
+}
+
+/*
+ * Evict the least recent evictable frame of list, caller must hold mutex_
+ */
+template <typename T> bool ARCReplacer<T>::Evict(std::list<size_t> &list,
+                                                 T &value) {
+  for (auto it = list.rbegin(); it != list.rend(); ++it) {
+    Slot &s = slots_[*it];
+    if (!s.evictable_) {
+      continue;
+    }
+    bool from_t1 = s.list_ == ListType::T1;
+    page_id_t key = s.key_;
+    Unlink(s);
+    s.evictable_ = false;
+    s.key_ = INVALID_PAGE_ID;
+    size_--;
+    if (from_t1) {
+      Remember(b1_, b1_index_, key);
+    } else {
+      Remember(b2_, b2_index_, key);
+    }
+    value = s.value_;
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Same order as Victim: the cold end of the list over its target first,
+ * then the cold end of the other one
+ */
+template <typename T>
+void ARCReplacer<T>::EvictionCandidates(std::vector<T> &values, size_t n) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool t1_first = !t1_.empty() && t1_.size() > target_;
+  for (auto *list : {t1_first ? &t1_ : &t2_, t1_first ? &t2_ : &t1_}) {
+    for (auto it = list->rbegin(); it != list->rend() && n > 0; ++it) {
+      const Slot &s = slots_[*it];
+      if (s.evictable_) {
+        values.push_back(s.value_);
+        n--;
+      }
+    }
+  }
+}
+
+template class ARCReplacer<Page *>;
+// test only
+template class ARCReplacer<int>;
+
+} // namespace cmudb
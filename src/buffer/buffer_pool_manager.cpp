@@ -1,38 +1,89 @@
+#include <algorithm>
+#include <cstring>
+
 #include "buffer/buffer_pool_manager.h"
 #include "common/logger.h"
 
 namespace cmudb {
 
+/*
+ * Replacer of the given policy for a pool of capacity frames
+ */
+static Replacer<Page *> *NewReplacer(ReplacerType replacer_type,
+                                     size_t replacer_k, size_t capacity) {
+  switch (replacer_type) {
+  case ReplacerType::CLOCK:
+    return new ClockReplacer<Page *>(capacity);
+  case ReplacerType::LRU_K:
+    return new LRUKReplacer<Page *>(replacer_k, capacity);
+  case ReplacerType::ARC:
+    return new ARCReplacer<Page *>(capacity);
+  default:
+    return new LRUReplacer<Page *>;
+  }
+}
+
 /*
  * BufferPoolManager Constructor
  * When log_manager is nullptr, logging is disabled (for test purpose)
- * WARNING: Do Not Edit This Function
  */
 BufferPoolManager::BufferPoolManager(size_t pool_size,
                                                  DiskManager *disk_manager,
-                                                 LogManager *log_manager)
+                                                 LogManager *log_manager,
+                                                 ReplacerType replacer_type,
+                                                 size_t replacer_k)
     : pool_size_(pool_size), disk_manager_(disk_manager),
-      log_manager_(log_manager) {
-  // a consecutive memory space for buffer pool
-  pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHash<page_id_t, Page *>(BUCKET_SIZE);
-  replacer_ = new LRUReplacer<Page *>;
+      log_manager_(log_manager), cleaner_thread_(nullptr),
+      cleaner_running_(false), prefetch_thread_(nullptr),
+      prefetch_stop_(false), shrinking_(false) {
+  page_table_ = new PageTable(pool_size_);
+  replacer_ = NewReplacer(replacer_type, replacer_k, pool_size_);
+  priority_replacer_ = NewReplacer(replacer_type, replacer_k, pool_size_);
   free_list_ = new std::list<Page *>;
 
   // put all the pages into free list
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_->push_back(&pages_[i]);
-  }
+  AddFrames(pool_size_);
 }
 
+/*
+ * Frame-less constructor for front ends that route every call to other
+ * buffer pools
+ */
+BufferPoolManager::BufferPoolManager()
+    : pool_size_(0), disk_manager_(nullptr), log_manager_(nullptr),
+      page_table_(nullptr), replacer_(nullptr), priority_replacer_(nullptr),
+      free_list_(nullptr),
+      cleaner_thread_(nullptr), cleaner_running_(false),
+      prefetch_thread_(nullptr), prefetch_stop_(false), shrinking_(false) {}
+
 /*
  * BufferPoolManager Deconstructor
- * WARNING: Do Not Edit This Function
  */
 BufferPoolManager::~BufferPoolManager() {
-  delete[] pages_;
+  StopCleanerThread();
+  if (prefetch_thread_ != nullptr) {
+    {
+      std::lock_guard<std::mutex> lock(latch_);
+      prefetch_stop_ = true;
+      prefetch_cv_.notify_one();
+    }
+    prefetch_thread_->join();
+    delete prefetch_thread_;
+  }
+  for (auto arena : arenas_) {
+    delete arena;
+  }
+  for (auto arena : retired_arenas_) {
+    delete arena;
+  }
+  delete[] frames_.load();
+  for (auto frames : retired_frames_) {
+    delete[] frames;
+  }
+  delete victim_cache_.load();
   delete page_table_;
   delete replacer_;
+  delete priority_replacer_;
   delete free_list_;
 }
 
@@ -46,52 +97,143 @@ BufferPoolManager::~BufferPoolManager() {
  * entry for the new page.
  * 4. Update page metadata, read page content from disk file and return page
  * pointer
+ *
+ * Concurrency: a hit of a RANDOM fetch does not take latch_ at all (see
+ * PinResident). Otherwise latch_ only protects the bookkeeping. The frame is
+ * claimed (pinned, mapped and marked io_in_progress_) under the latch, then
+ * the write-back of the old page and the read of the new one happen without
+ * it. Threads fetching the same page meanwhile find the frame in the page
+ * table and wait on that frame only.
+ *
+ * Access hints: a SEQUENTIAL_SCAN hit pins the page without counting as a
+ * reuse, and a SEQUENTIAL_SCAN miss with a strategy takes its frame from the
+ * ring of the strategy before falling back to free list and replacer.
+ */
+Page *BufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type,
+                                   BufferAccessStrategy *strategy) {
+  Page *page = PinPage(page_id, access_type, strategy);
+  // traced once done, like NewPage, so that a failure is on record
+  TraceCall(TraceOp::FETCH, page != nullptr ? page_id : INVALID_PAGE_ID,
+            access_type == AccessType::SEQUENTIAL_SCAN);
+  return page;
+}
+
+/*
+ * Body of FetchPage, without the trace record
  */
-Page *BufferPoolManager::FetchPage(page_id_t page_id) {
+Page *BufferPoolManager::PinPage(page_id_t page_id, AccessType access_type,
+                                 BufferAccessStrategy *strategy) {
   assert(page_id != INVALID_PAGE_ID);
+  if (access_type != AccessType::SEQUENTIAL_SCAN) {
+    strategy = nullptr;
+  }
+  auto start = stats_.StartTimer();
   Page * page = nullptr;
-  if (page_table_->Find(page_id, page)) {
-    page->pin_count_++;
-    if (page->pin_count_ >= 4) {
-      page->pin_count_++;
-      page->pin_count_--;
+  if (access_type != AccessType::SEQUENTIAL_SCAN) {
+    page = PinResident(page_id);
+    if (page != nullptr) {
+      stats_.Add(StatsCounter::HIT);
+      stats_.RecordLatency(StatsHistogram::FETCH_HIT, start);
+      return page;
     }
+  }
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    if (FindPage(page_id, page)) {
+      page->pin_count_++;
 
-    // Delete page in LRU replacer!
-    replacer_->Erase(page);
-    
-    //LOG_INFO("FetchPage: page id %s still in hashtable, count: %d", std::to_string(page_id).c_str(), page->pin_count_);
-    return page;
-  } else {
-    if (!free_list_->empty()) {
-      page = free_list_->front();
-      free_list_->pop_front();
-    } else {
-      // Every time we victim a page, we need to write to disk if dirty
-      // Then remove old entry from hashtable, and insert new entry
-      if (!replacer_->Victim(page)) {
-        assert(0);
-        return nullptr;
+      // Delete page in LRU replacer!
+      if (access_type == AccessType::SEQUENTIAL_SCAN) {
+        ReplacerOf(page)->Erase(page);
+      } else {
+        ReplacerOf(page)->RecordAccess(page);
       }
+
+      // another thread may still be loading this page
+      WaitForIO(page, lock);
+      stats_.Add(StatsCounter::HIT);
+      stats_.RecordLatency(StatsHistogram::FETCH_HIT, start);
+      return page;
+    }
+    // an evicted dirty copy of this page may still be on its way to disk,
+    // reading it now would return stale data
+    if (write_back_.count(page_id) != 0) {
+      write_back_cv_.wait(lock);
+      continue;
     }
-  }
 
-  assert(page->pin_count_ == 0);
-  if (page->is_dirty_) {
-    // write existing data back to disk
-    disk_manager_->WritePage(page->page_id_, page->GetData());
+    page = ClaimFrame(strategy, lock);
+    if (page == nullptr) {
+      stats_.Add(StatsCounter::PIN_FAILURE);
+      return nullptr;
+    }
+    // the latch may have been released, somebody else may have loaded the
+    // page meanwhile
+    Page *loaded = nullptr;
+    if (!FindPage(page_id, loaded) &&
+        write_back_.count(page_id) == 0) {
+      break;
+    }
+    ReleaseFrame(page);
   }
 
-  page_table_->Remove(page->page_id_);
+  if (strategy != nullptr) {
+    AddToRing(strategy, page_id);
+  }
+  LoadFrame(page, page_id, true, lock);
+  stats_.Add(StatsCounter::MISS);
+  stats_.RecordLatency(StatsHistogram::FETCH_MISS, start);
+  return page;
+}
 
-  page_table_->Insert(page_id, page);
+/*
+ * Hit path of FetchPage without latch_: look the frame up in the page
+ * table, pin it with a compare-and-swap that fails on a claimed frame, then
+ * check that the frame still holds page_id and is not being loaded. A
+ * claimed frame cannot be mapped to another page, so a pin taken this way
+ * keeps the page resident. nullptr on a miss or when the frame changed
+ * hands, FetchPage then takes the latched path. The access reaches the
+ * replacer on the unpin, see UnpinLocked.
+ */
+Page *BufferPoolManager::PinResident(page_id_t page_id) {
+  frame_id_t frame_id;
+  if (!page_table_->Find(page_id, frame_id)) {
+    return nullptr;
+  }
+  // the frame table is published before any page table entry of its frames
+  Page *page = frames_.load(std::memory_order_acquire)[frame_id].load(
+      std::memory_order_acquire);
+  if (page == nullptr) {
+    return nullptr;
+  }
+  int pin_count = page->pin_count_.load(std::memory_order_relaxed);
+  do {
+    if (pin_count == Page::FRAME_CLAIMED) {
+      return nullptr;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(
+      pin_count, pin_count + 1, std::memory_order_acquire,
+      std::memory_order_relaxed));
+  if (page->page_id_.load(std::memory_order_acquire) == page_id &&
+      !page->io_in_progress_.load(std::memory_order_acquire)) {
+    page->accessed_.store(true, std::memory_order_relaxed);
+    return page;
+  }
+  // evicted and reused since the lookup, or still being read
+  std::lock_guard<std::mutex> lock(latch_);
+  UnpinLocked(page, false);
+  return nullptr;
+}
 
-  page->pin_count_ = 1;
-  page->is_dirty_ = false;    
-  page->page_id_ = page_id;
-  //LOG_INFO("FetchPage final: page id %s inserted, and pin count is %d. load from disk", std::to_string(page_id).c_str(), page->pin_count_);
-  disk_manager_->ReadPage(page_id, page->GetData());
-  return page;
+/*
+ * Take an unpinned frame away from hits without latch_: its pin count goes
+ * from 0 to FRAME_CLAIMED, false if a hit pinned it first. Caller must hold
+ * latch_.
+ */
+bool BufferPoolManager::ClaimUnpinned(Page *page) {
+  int pin_count = 0;
+  return page->pin_count_.compare_exchange_strong(pin_count,
+                                                  Page::FRAME_CLAIMED);
 }
 
 /*
@@ -101,42 +243,221 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
  * dirty flag of this page
  */
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  TraceCall(TraceOp::UNPIN, page_id, is_dirty);
+  std::lock_guard<std::mutex> lock(latch_);
+  return UnpinLocked(page_id, is_dirty);
+}
+
+/*
+ * Unpin a set of pages under one acquisition of latch_, page_ids[i] with
+ * dirty flag is_dirty[i]. Return false if any of them was not pinned, the
+ * others are unpinned all the same
+ */
+bool BufferPoolManager::UnpinPages(const std::vector<page_id_t> &page_ids,
+                                   const std::vector<bool> &is_dirty) {
+  assert(page_ids.size() == is_dirty.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    TraceCall(TraceOp::UNPIN, page_ids[i], is_dirty[i]);
+  }
+  std::lock_guard<std::mutex> lock(latch_);
+  bool all_unpinned = true;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    all_unpinned = UnpinLocked(page_ids[i], is_dirty[i]) && all_unpinned;
+  }
+  return all_unpinned;
+}
+
+/*
+ * Body of UnpinPage. Caller must hold latch_
+ */
+bool BufferPoolManager::UnpinLocked(page_id_t page_id, bool is_dirty) {
   Page * page = nullptr;
-  if (page_table_->Find(page_id, page)) {
-    if (page->pin_count_ <= 0) {
-      return false;
-    }
-    page->pin_count_--;
-    if (page->pin_count_ == 0) {
-      /*if (page->page_id_ == 0) {
-        if (page_table_->Find(page_id, page)) {
-              assert(page->page_id_ == 0);     
-        } 
-      }*/
-      replacer_->Insert(page);
-    }
-    //LOG_INFO("page id %d inserted to hashtable, pin count: %d", page_id, page->pin_count_);
-    if (is_dirty) {
-      page->is_dirty_ = true;
-    }
-    return true;
+  if (FindPage(page_id, page)) {
+    return UnpinLocked(page, is_dirty);
   }
   return false;
 }
 
+bool BufferPoolManager::UnpinLocked(Page *page, bool is_dirty) {
+  if (page->pin_count_ <= 0) {
+    return false;
+  }
+  // a hit without latch_ left the replacer alone
+  if (page->accessed_.exchange(false, std::memory_order_relaxed)) {
+    ReplacerOf(page)->RecordAccess(page);
+  }
+  if (--page->pin_count_ == 0) {
+    ReplacerOf(page)->Insert(page);
+    if (shrinking_) {
+      unpin_cv_.notify_all();
+    }
+  }
+  if (is_dirty) {
+    page->is_dirty_ = true;
+  }
+  return true;
+}
+
+/*
+ * UnpinPage for a caller that still has the Page the pool handed out, so
+ * there is no page table lookup. The page id is only read for the trace: a
+ * pinned frame keeps its page
+ */
+bool BufferPoolManager::UnpinFrame(Page *page, bool is_dirty) {
+  TraceCall(TraceOp::UNPIN, page->GetPageId(), is_dirty);
+  std::lock_guard<std::mutex> lock(latch_);
+  return UnpinLocked(page, is_dirty);
+}
+
+ReadPageGuard BufferPoolManager::FetchPageRead(page_id_t page_id,
+                                               AccessType access_type,
+                                               BufferAccessStrategy *strategy) {
+  Page *page = FetchPage(page_id, access_type, strategy);
+  if (page == nullptr) {
+    return ReadPageGuard();
+  }
+  page->RLatch();
+  return ReadPageGuard(this, page);
+}
+
+WritePageGuard BufferPoolManager::FetchPageWrite(page_id_t page_id) {
+  Page *page = FetchPage(page_id);
+  if (page == nullptr) {
+    return WritePageGuard();
+  }
+  page->WLatch();
+  return WritePageGuard(this, page);
+}
+
+/*
+ * NewPage under a write guard. The guard starts out dirty, a new page has
+ * to be written even if nobody fills it
+ */
+WritePageGuard BufferPoolManager::NewPageGuarded(page_id_t &page_id) {
+  Page *page = NewPage(page_id);
+  if (page == nullptr) {
+    return WritePageGuard();
+  }
+  page->WLatch();
+  return WritePageGuard(this, page, true);
+}
+
 /*
  * Used to flush a particular page of the buffer pool to disk. Should call the
  * write_page method of the disk manager
  * if page is not found in page table, return false
  * NOTE: make sure page_id != INVALID_PAGE_ID
+ * The page is pinned for the duration of the write so it cannot be evicted
+ * while latch_ is released.
  */
-bool BufferPoolManager::FlushPage(page_id_t page_id) { 
+bool BufferPoolManager::FlushPage(page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(latch_);
   Page * page = nullptr;
-  if (page_id == INVALID_PAGE_ID || !page_table_->Find(page_id, page)) {
+  if (page_id == INVALID_PAGE_ID || !FindPage(page_id, page)) {
     return false;
   }
-  disk_manager_->WritePage(page_id, page->GetData());
-  return true; 
+  page->pin_count_++;
+  ReplacerOf(page)->Erase(page);
+  WaitForIO(page, lock);
+  // the page cleaner may be writing an older copy
+  while (write_back_.count(page_id) != 0) {
+    write_back_cv_.wait(lock);
+  }
+  page->is_dirty_ = false;
+  lock.unlock();
+
+  WriteBack(page_id, page);
+
+  lock.lock();
+  if (--page->pin_count_ == 0) {
+    ReplacerOf(page)->Insert(page);
+    if (shrinking_) {
+      unpin_cv_.notify_all();
+    }
+  }
+  return true;
+}
+
+size_t BufferPoolManager::FlushAllPages() {
+  return FlushDirtyPages([](page_id_t) { return true; });
+}
+
+/*
+ * Write out the dirty pages whose page id the predicate accepts, e.g. for a
+ * checkpoint. Like FlushPage, the pages are pinned and marked clean under
+ * latch_ and written without it; a change made meanwhile dirties the page
+ * again on its unpin. The pages are sorted by page id and every run of
+ * consecutive ids is one DiskManager::WritePages, the file is synced once
+ * after the last run. The predicate is called with latch_ held and must not
+ * call back into the pool.
+ */
+size_t BufferPoolManager::FlushDirtyPages(
+    const std::function<bool(page_id_t)> &predicate) {
+  std::unique_lock<std::mutex> lock(latch_);
+  std::vector<Page *> batch;
+  while (true) {
+    bool cleaning = false;
+    std::atomic<Page *> *frames = frames_.load(std::memory_order_relaxed);
+    for (size_t frame_id = 0; frame_id < num_frame_ids_; ++frame_id) {
+      Page *page = frames[frame_id];
+      if (page == nullptr || !page->is_dirty_ || page->io_in_progress_ ||
+          !predicate(page->page_id_)) {
+        continue;
+      }
+      // the page cleaner may be writing an older copy
+      if (write_back_.count(page->page_id_) != 0) {
+        cleaning = true;
+        break;
+      }
+      batch.push_back(page);
+    }
+    if (!cleaning) {
+      break;
+    }
+    batch.clear();
+    write_back_cv_.wait(lock);
+  }
+  if (batch.empty()) {
+    return 0;
+  }
+  lsn_t max_lsn = INVALID_LSN;
+  for (auto page : batch) {
+    page->pin_count_++;
+    ReplacerOf(page)->Erase(page);
+    page->is_dirty_ = false;
+    max_lsn = std::max(max_lsn, page->GetLSN());
+  }
+  lock.unlock();
+
+  // WAL: one wait for the log covers the whole batch
+  if (ENABLE_LOGGING && log_manager_ != nullptr) {
+    log_manager_->WaitForPersistentLSN(max_lsn);
+  }
+  std::sort(batch.begin(), batch.end(), [](Page *a, Page *b) {
+    return a->page_id_ < b->page_id_;
+  });
+  std::vector<const char *> run;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    run.push_back(batch[i]->GetData());
+    if (i + 1 == batch.size() ||
+        batch[i + 1]->page_id_ != batch[i]->page_id_ + 1) {
+      disk_manager_->WritePages(batch[i]->page_id_ - (run.size() - 1),
+                                run.size(), run.data());
+      run.clear();
+    }
+  }
+  disk_manager_->Sync();
+
+  lock.lock();
+  for (auto page : batch) {
+    if (--page->pin_count_ == 0) {
+      ReplacerOf(page)->Insert(page);
+    }
+  }
+  if (shrinking_) {
+    unpin_cv_.notify_all();
+  }
+  return batch.size();
 }
 
 /**
@@ -147,28 +468,45 @@ bool BufferPoolManager::FlushPage(page_id_t page_id) {
  * call disk manager's DeallocatePage() method to delete from disk file. If
  * the page is found within page table, but pin_count != 0, return false
  */
-bool BufferPoolManager::DeletePage(page_id_t page_id) { 
+bool BufferPoolManager::DeletePage(page_id_t page_id) {
+  TraceCall(TraceOp::DELETE, page_id);
+  stats_.Add(StatsCounter::DELETE_PAGE);
+  // a page that is not resident may be in the compressed tier or the
+  // victim cache
+  compressed_tier_.Erase(page_id);
+  VictimCache *victim_cache = victim_cache_.load(std::memory_order_acquire);
+  if (victim_cache != nullptr) {
+    victim_cache->Erase(page_id);
+  }
+  std::lock_guard<std::mutex> lock(latch_);
   Page * page = nullptr;
-  if (page_id == INVALID_PAGE_ID || !page_table_->Find(page_id, page)) {
+  if (page_id == INVALID_PAGE_ID || !FindPage(page_id, page)) {
     return false;
   }
 
-  if (page->pin_count_ != 0) {
+  // a frame under I/O is always pinned by the thread doing it. Claiming
+  // the frame keeps hits without latch_ away from it
+  if (!ClaimUnpinned(page)) {
     return false;
   }
 
   page->ResetMemory();
   // add to free list, remove from lRU, and hashtable
-  
-  replacer_->Erase(page);
+
+  ReplacerOf(page)->Remove(page);
   page_table_->Remove(page_id);
   disk_manager_->DeallocatePage(page_id);
 
   page->page_id_ = INVALID_PAGE_ID;
   page->is_dirty_ = false;
+  page->priority_ = PagePriority::NORMAL;
+  high_priority_pages_.erase(page_id);
   free_list_->push_back(page);
+  if (shrinking_) {
+    unpin_cv_.notify_all();
+  }
 
-  return true; 
+  return true;
 }
 
 /**
@@ -178,43 +516,936 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
  * from free list or lru replacer(NOTE: always choose from free list first),
  * update new page's metadata, zero out memory and add corresponding entry
  * into page table. return nullptr if all the pages in pool are pinned
+ * Like FetchPage, the write-back of a dirty victim happens without latch_.
+ */
+Page *BufferPoolManager::NewPage(page_id_t &page_id) {
+  Page *res = CreatePage(page_id, true);
+  TraceCall(TraceOp::NEW, res != nullptr ? page_id : INVALID_PAGE_ID);
+  return res;
+}
+
+/*
+ * Body of NewPage, without the trace record. The page id is allocated from
+ * the disk manager once a frame is found, unless allocate is false: then
+ * the caller allocated page_id already (see ParallelBufferPoolManager)
+ */
+Page *BufferPoolManager::CreatePage(page_id_t &page_id, bool allocate) {
+  stats_.Add(StatsCounter::NEW_PAGE);
+  std::unique_lock<std::mutex> lock(latch_);
+  Page * res = ClaimFrame(nullptr, lock);
+  if (res == nullptr) {
+    stats_.Add(StatsCounter::PIN_FAILURE);
+    return nullptr;
+  }
+
+  assert(res->pin_count_ == Page::FRAME_CLAIMED);
+  page_id_t old_page_id = res->page_id_;
+  bool write_back = res->is_dirty_;
+  CountVictim(old_page_id, write_back);
+  if (old_page_id != INVALID_PAGE_ID) {
+    LOG_INFO("page id %s is victim page, removed!", std::to_string(old_page_id).c_str());
+    page_table_->Remove(old_page_id);
+  }
+
+  if (allocate) {
+    page_id = disk_manager_->AllocatePage();
+  }
+  page_table_->Insert(page_id, res->frame_id_);
+
+  res->page_id_ = page_id;
+  res->is_dirty_ = false;
+  res->io_in_progress_ = true;
+  res->priority_ = PriorityOf(page_id);
+  res->pin_count_ = 1;
+  ReplacerOf(res)->RecordAccess(res);
+  bool spill = NeedsSpill(old_page_id, write_back);
+  if (spill) {
+    write_back_.insert(old_page_id);
+  }
+  lock.unlock();
+
+  if (spill) {
+    SpillPage(old_page_id, write_back, res);
+  }
+  res->ResetMemory();
+
+  lock.lock();
+  FinishIO(res, spill ? old_page_id : INVALID_PAGE_ID);
+  return res;
+}
+
+/*
+ * Map a claimed frame to page_id and read the page into it: the old page
+ * goes out of the page table and, if dirty, is written back, all without
+ * latch_. Returns with the frame pinned once. record_access is false for
+ * prefetches, which are not a use of the page. Caller must hold latch_
+ * through lock.
+ */
+void BufferPoolManager::LoadFrame(Page *page, page_id_t page_id,
+                                  bool record_access,
+                                  std::unique_lock<std::mutex> &lock) {
+  bool dirty;
+  page_id_t old_page_id = MapFrame(page, page_id, record_access, dirty);
+  lock.unlock();
+
+  if (old_page_id != INVALID_PAGE_ID) {
+    // write existing data back to disk
+    SpillPage(old_page_id, dirty, page);
+  }
+  if (!TakeSpilled(page_id, page)) {
+    disk_manager_->ReadPage(page_id, page->GetData());
+  }
+
+  lock.lock();
+  FinishIO(page, old_page_id);
+}
+
+/*
+ * First half of LoadFrame: map the frame to page_id, pinned once and marked
+ * io_in_progress_. Returns the id of the old page if it must be spilled
+ * before the read, written back because it is dirty (dirty is set) and/or
+ * put into the compressed tier, INVALID_PAGE_ID otherwise. Caller must hold
+ * latch_.
+ */
+page_id_t BufferPoolManager::MapFrame(Page *page, page_id_t page_id,
+                                      bool record_access, bool &dirty) {
+  // Every time we victim a page, we need to write to disk if dirty
+  // Then remove old entry from hashtable, and insert new entry
+  assert(page->pin_count_ == Page::FRAME_CLAIMED);
+  page_id_t old_page_id = page->page_id_;
+  bool write_back = page->is_dirty_;
+  CountVictim(old_page_id, write_back);
+  if (old_page_id != INVALID_PAGE_ID) {
+    page_table_->Remove(old_page_id);
+  }
+  page_table_->Insert(page_id, page->frame_id_);
+
+  page->is_dirty_ = false;
+  page->page_id_ = page_id;
+  page->io_in_progress_ = true;
+  page->priority_ = PriorityOf(page_id);
+  // last, a hit without latch_ checks the rest once it got its pin
+  page->pin_count_ = 1;
+  if (record_access) {
+    ReplacerOf(page)->RecordAccess(page);
+  }
+  dirty = write_back;
+  if (!NeedsSpill(old_page_id, write_back)) {
+    return INVALID_PAGE_ID;
+  }
+  write_back_.insert(old_page_id);
+  return old_page_id;
+}
+
+/*
+ * Whether an evicted page has to go somewhere before its frame is reused:
+ * to disk if dirty, into the compressed tier and the victim cache if there
+ * are any. Until then its id is in write_back_, so that nobody fetches it
+ * meanwhile
+ */
+bool BufferPoolManager::NeedsSpill(page_id_t old_page_id, bool dirty) {
+  return old_page_id != INVALID_PAGE_ID &&
+         (dirty || compressed_tier_.IsEnabled() ||
+          victim_cache_.load(std::memory_order_acquire) != nullptr);
+}
+
+/*
+ * Second half of an eviction, called without latch_ while the frame still
+ * holds the old page: write it back if dirty, keep it in the compressed
+ * tier if there is one. The tiers are exclusive, the victim cache only gets
+ * what the compressed tier does not keep or drops to make room
+ */
+void BufferPoolManager::SpillPage(page_id_t old_page_id, bool dirty,
+                                  Page *page) {
+  if (dirty) {
+    WriteBack(old_page_id, page);
+  }
+  VictimCache *victim_cache = victim_cache_.load(std::memory_order_acquire);
+  if (!compressed_tier_.IsEnabled()) {
+    if (victim_cache != nullptr) {
+      victim_cache->Put(old_page_id, page->GetData());
+    }
+    return;
+  }
+  std::vector<CompressedTier::Entry> dropped;
+  bool kept = compressed_tier_.Put(
+      old_page_id, page->GetData(), victim_cache != nullptr ? &dropped : nullptr);
+  if (victim_cache == nullptr) {
+    return;
+  }
+  if (!kept) {
+    victim_cache->Put(old_page_id, page->GetData());
+  }
+  // a dropped page may be fetched meanwhile, read from disk and be resident
+  // with a copy in the cache. That copy is clean, and the next eviction of
+  // the page replaces it or takes it out again before anybody reads it
+  std::vector<char> data(dropped.empty() ? 0 : PAGE_SIZE);
+  for (auto &entry : dropped) {
+    if (CompressedTier::Decompress(entry, data.data())) {
+      victim_cache->Put(entry.page_id_, data.data());
+    }
+  }
+}
+
+/*
+ * Read page_id from the compressed tier or else the victim cache instead of
+ * the database file, if one of them has it. Either way the page leaves both,
+ * neither may keep a copy of a resident page. Called without latch_ on a
+ * frame under I/O
+ */
+bool BufferPoolManager::TakeSpilled(page_id_t page_id, Page *page) {
+  VictimCache *victim_cache = victim_cache_.load(std::memory_order_acquire);
+  if (compressed_tier_.IsEnabled() &&
+      compressed_tier_.Take(page_id, page->GetData())) {
+    stats_.Add(StatsCounter::COMPRESSED_TIER_HIT);
+    if (victim_cache != nullptr) {
+      victim_cache->Erase(page_id);
+    }
+    return true;
+  }
+  if (victim_cache != nullptr && victim_cache->Take(page_id, page->GetData())) {
+    stats_.Add(StatsCounter::VICTIM_CACHE_HIT);
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Spill evicted pages into a cache file of num_pages slots, on a device
+ * faster than the one of the database file. Only one victim cache per pool:
+ * return false if there already is one or the file cannot be created
+ */
+bool BufferPoolManager::EnableVictimCache(const std::string &file_name,
+                                          size_t num_pages) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (victim_cache_.load(std::memory_order_relaxed) != nullptr) {
+    return false;
+  }
+  auto victim_cache = new VictimCache(file_name, num_pages);
+  if (!victim_cache->IsOpen()) {
+    delete victim_cache;
+    return false;
+  }
+  victim_cache_.store(victim_cache, std::memory_order_release);
+  return true;
+}
+
+/*
+ * Keep up to budget bytes of evicted pages compressed in memory, 0 turns the
+ * tier off and drops whatever it holds
+ */
+void BufferPoolManager::SetCompressedTierBudget(size_t budget) {
+  compressed_tier_.SetBudget(budget);
+}
+
+/*
+ * Pin a whole set of pages at once, pages[i] holds page_ids[i]. Hits are
+ * pinned and every miss gets its frame under one acquisition of latch_.
+ * Then, without the latch, dirty victims are written back and the missing
+ * pages are read sorted by page id, each run of consecutive ids with a
+ * single DiskManager::ReadPages. A page whose evicted copy is still being
+ * written back is fetched on its own at the end rather than waited for with
+ * frames of the batch in flight, two batches could wait for each other's
+ * write-backs. If the pool runs out of unpinned frames, whatever was pinned
+ * is unpinned again and false is returned with pages all nullptr.
+ */
+bool BufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids,
+                                   std::vector<Page *> &pages,
+                                   AccessType access_type) {
+  pages.assign(page_ids.size(), nullptr);
+  // a frame this call loads
+  struct Load {
+    page_id_t page_id_;
+    Page *page_;
+    page_id_t old_page_id_; // to spill first, or INVALID_PAGE_ID
+    bool dirty_;            // old page needs a write-back
+  };
+  std::vector<Load> loads;
+  std::vector<size_t> deferred;
+  std::unique_lock<std::mutex> lock(latch_);
+  bool failed = false;
+  for (size_t i = 0; i < page_ids.size() && !failed; ++i) {
+    page_id_t page_id = page_ids[i];
+    assert(page_id != INVALID_PAGE_ID);
+    while (true) {
+      Page *page = nullptr;
+      if (FindPage(page_id, page)) {
+        page->pin_count_++;
+        if (access_type == AccessType::SEQUENTIAL_SCAN) {
+          ReplacerOf(page)->Erase(page);
+        } else {
+          ReplacerOf(page)->RecordAccess(page);
+        }
+        stats_.Add(StatsCounter::HIT);
+        pages[i] = page;
+        break;
+      }
+      if (write_back_.count(page_id) != 0) {
+        deferred.push_back(i);
+        break;
+      }
+      page = ClaimFrame(nullptr, lock);
+      if (page == nullptr) {
+        stats_.Add(StatsCounter::PIN_FAILURE);
+        failed = true;
+        break;
+      }
+      Page *loaded = nullptr;
+      if (FindPage(page_id, loaded) || write_back_.count(page_id) != 0) {
+        ReleaseFrame(page);
+        continue;
+      }
+      Load load{page_id, page, INVALID_PAGE_ID, false};
+      load.old_page_id_ = MapFrame(page, page_id, true, load.dirty_);
+      loads.push_back(load);
+      stats_.Add(StatsCounter::MISS);
+      pages[i] = page;
+      break;
+    }
+  }
+  lock.unlock();
+
+  // write-backs first, in page id order
+  std::sort(loads.begin(), loads.end(), [](const Load &a, const Load &b) {
+    return a.old_page_id_ < b.old_page_id_;
+  });
+  for (auto &load : loads) {
+    if (load.old_page_id_ != INVALID_PAGE_ID) {
+      SpillPage(load.old_page_id_, load.dirty_, load.page_);
+    }
+  }
+  // pages in the compressed tier need no read, the others are read in runs
+  std::vector<Load> reads;
+  for (auto &load : loads) {
+    if (!TakeSpilled(load.page_id_, load.page_)) {
+      reads.push_back(load);
+    }
+  }
+  std::sort(reads.begin(), reads.end(), [](const Load &a, const Load &b) {
+    return a.page_id_ < b.page_id_;
+  });
+  std::vector<char *> run;
+  for (size_t i = 0; i < reads.size(); ++i) {
+    run.push_back(reads[i].page_->GetData());
+    if (i + 1 == reads.size() ||
+        reads[i + 1].page_id_ != reads[i].page_id_ + 1) {
+      disk_manager_->ReadPages(reads[i].page_id_ - (run.size() - 1),
+                               run.size(), run.data());
+      run.clear();
+    }
+  }
+
+  lock.lock();
+  for (auto &load : loads) {
+    FinishIO(load.page_, load.old_page_id_);
+  }
+  // hits may still be loading in another thread
+  for (auto page : pages) {
+    if (page != nullptr) {
+      WaitForIO(page, lock);
+    }
+  }
+  lock.unlock();
+  for (size_t i = 0; i < deferred.size() && !failed; ++i) {
+    pages[deferred[i]] = PinPage(page_ids[deferred[i]], access_type, nullptr);
+    failed = pages[deferred[i]] == nullptr;
+  }
+  if (!failed) {
+    // a failed batch has no effect, only a complete one is traced
+    for (auto page_id : page_ids) {
+      TraceCall(TraceOp::FETCH, page_id,
+                access_type == AccessType::SEQUENTIAL_SCAN);
+    }
+    return true;
+  }
+  lock.lock();
+  for (size_t i = 0; i < pages.size(); ++i) {
+    if (pages[i] != nullptr) {
+      UnpinLocked(page_ids[i], false);
+      pages[i] = nullptr;
+    }
+  }
+  return false;
+}
+
+/*
+ * Give back a frame returned by ClaimFrame that ended up unused. Caller must
+ * hold latch_.
+ */
+void BufferPoolManager::ReleaseFrame(Page *page) {
+  if (page->page_id_ == INVALID_PAGE_ID) {
+    free_list_->push_front(page);
+  } else {
+    page->pin_count_ = 0;
+    ReplacerOf(page)->Insert(page);
+  }
+  if (shrinking_) {
+    unpin_cv_.notify_all();
+  }
+}
+
+/*
+ * Take a frame returned by ClaimFrame out of the pool, after writing back
+ * its page if dirty; the page data of its arena is released once no frame
+ * of it is left. The page leaves the page table first, a fetch of it
+ * meanwhile waits for the write-back and reads it into another frame.
+ * Caller must hold latch_ through lock, it is released for the write.
+ */
+void BufferPoolManager::DropFrame(Page *page,
+                                  std::unique_lock<std::mutex> &lock) {
+  assert(page->pin_count_ == Page::FRAME_CLAIMED);
+  page_id_t old_page_id = page->page_id_;
+  bool write_back = page->is_dirty_;
+  if (old_page_id != INVALID_PAGE_ID) {
+    page_table_->Remove(old_page_id);
+    ReplacerOf(page)->Remove(page);
+  }
+  frames_.load(std::memory_order_relaxed)[page->frame_id_] = nullptr;
+  pool_size_--;
+  if (write_back) {
+    stats_.Add(StatsCounter::DIRTY_WRITE_BACK);
+    write_back_.insert(old_page_id);
+    lock.unlock();
+    WriteBack(old_page_id, page);
+    lock.lock();
+    FinishIO(page, old_page_id);
+  }
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  // release the arena with its last frame
+  for (auto it = arenas_.begin(); it != arenas_.end(); ++it) {
+    if ((*it)->Contains(page->frame_id_)) {
+      if (--(*it)->live_frames_ == 0) {
+        (*it)->ReleaseData();
+        retired_arenas_.push_back(*it);
+        arenas_.erase(it);
+      }
+      break;
+    }
+  }
+}
+
+/*
+ * Start loading page_id into an unpinned frame without waiting for it. The
+ * page is read by a background thread, a FetchPage of it then is a hit, or
+ * waits for the read in flight. Prefetching is a hint: pages already in the
+ * pool are ignored, and requests are dropped when every frame is pinned or
+ * pool_size_ requests are already queued.
+ */
+void BufferPoolManager::PrefetchPage(
+    page_id_t page_id, std::shared_ptr<BufferAccessStrategy> strategy) {
+  PrefetchPages(std::vector<page_id_t>{page_id}, strategy);
+}
+
+void BufferPoolManager::PrefetchPages(
+    const std::vector<page_id_t> &page_ids,
+    std::shared_ptr<BufferAccessStrategy> strategy) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (pool_size_ == 0) {
+    return;
+  }
+  for (auto page_id : page_ids) {
+    Page *page = nullptr;
+    if (page_id == INVALID_PAGE_ID || prefetch_queue_.size() >= pool_size_ ||
+        FindPage(page_id, page)) {
+      continue;
+    }
+    prefetch_queue_.emplace_back(page_id, strategy);
+  }
+  if (prefetch_queue_.empty()) {
+    return;
+  }
+  if (prefetch_thread_ == nullptr) {
+    prefetch_thread_ = new std::thread(&BufferPoolManager::PrefetchLoop, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+/*
+ * Body of the prefetch thread: read queued pages one at a time until the
+ * pool is destroyed
  */
-Page *BufferPoolManager::NewPage(page_id_t &page_id) {  
-  Page * res = nullptr;
+void BufferPoolManager::PrefetchLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    while (!prefetch_stop_ && prefetch_queue_.empty()) {
+      prefetch_cv_.wait(lock);
+    }
+    if (prefetch_stop_) {
+      break;
+    }
+    page_id_t page_id = prefetch_queue_.front().first;
+    auto strategy = prefetch_queue_.front().second;
+    prefetch_queue_.pop_front();
+
+    Page *page = nullptr;
+    if (FindPage(page_id, page) || write_back_.count(page_id) != 0) {
+      continue;
+    }
+    page = ClaimFrame(strategy.get(), lock);
+    if (page == nullptr) {
+      continue;
+    }
+    Page *loaded = nullptr;
+    if (FindPage(page_id, loaded) ||
+        write_back_.count(page_id) != 0) {
+      ReleaseFrame(page);
+      continue;
+    }
+    if (strategy != nullptr) {
+      AddToRing(strategy.get(), page_id);
+    }
+    LoadFrame(page, page_id, false, lock);
+    // drop the pin of the read, the page waits unpinned for its fetch
+    if (--page->pin_count_ == 0) {
+      ReplacerOf(page)->Insert(page);
+      if (shrinking_) {
+        unpin_cv_.notify_all();
+      }
+    }
+  }
+}
+
+/*
+ * Pick a frame for a new page: always from free list first, then ask the
+ * replacer for a victim. Return nullptr if every frame is pinned.
+ * Caller must hold latch_.
+ */
+Page *BufferPoolManager::GetVictimFrame() {
+  Page *page = nullptr;
   if (!free_list_->empty()) {
-    res = free_list_->front();
+    page = free_list_->front();
     free_list_->pop_front();
+    return page;
+  }
+  // HIGH priority pages only go when there is nothing else. A page that a
+  // hit without latch_ pinned is passed over and given back to its
+  // replacer as resident, its unpin makes it evictable again
+  while (replacer_->Victim(page) || priority_replacer_->Victim(page)) {
+    if (ClaimUnpinned(page)) {
+      return page;
+    }
+    ReplacerOf(page)->Restore(page);
+  }
+  return nullptr;
+}
+
+/*
+ * Replacer the page is in while unpinned, by its priority. Caller must hold
+ * latch_.
+ */
+Replacer<Page *> *BufferPoolManager::ReplacerOf(Page *page) {
+  return page->priority_ == PagePriority::HIGH ? priority_replacer_
+                                               : replacer_;
+}
+
+/*
+ * Priority of page_id while it is resident. Caller must hold latch_.
+ */
+PagePriority BufferPoolManager::PriorityOf(page_id_t page_id) {
+  return high_priority_pages_.count(page_id) != 0 ? PagePriority::HIGH
+                                                  : PagePriority::NORMAL;
+}
+
+/*
+ * Put a page into an eviction class. The priority belongs to the page id, it
+ * is kept while the page is not resident and applies whenever the page is
+ * loaded again, until the page is deleted. A resident page moves between the
+ * replacers at once, it loses its access history on the way.
+ */
+void BufferPoolManager::SetPagePriority(page_id_t page_id,
+                                        PagePriority priority) {
+  assert(page_id != INVALID_PAGE_ID);
+  std::lock_guard<std::mutex> lock(latch_);
+  if (priority == PagePriority::HIGH) {
+    high_priority_pages_.insert(page_id);
   } else {
-    if (!replacer_->Victim(res)) {
-      //assert(0);
+    high_priority_pages_.erase(page_id);
+  }
+  Page *page = nullptr;
+  if (!FindPage(page_id, page) || page->priority_ == priority) {
+    return;
+  }
+  ReplacerOf(page)->Remove(page);
+  page->priority_ = priority;
+  // a pinned page goes into its replacer on the last unpin
+  if (page->pin_count_ == 0) {
+    ReplacerOf(page)->Insert(page);
+  }
+}
+
+/*
+ * Resident, being loaded, or evicted but still being written back or
+ * spilled: in all these cases a reader of the database file could see an
+ * older version than readers of the pool
+ */
+bool BufferPoolManager::IsPageCached(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  Page *page = nullptr;
+  return FindPage(page_id, page) || write_back_.count(page_id) != 0;
+}
+
+std::shared_ptr<MappedFile> BufferPoolManager::MapDatabaseFile() {
+  return disk_manager_->MapFile();
+}
+
+/*
+ * Pick the frame for a page that is not in the pool: from the ring of the
+ * strategy if there is one, then free list, then replacer. A dirty victim
+ * that the page cleaner is still writing goes back to the replacer and we
+ * wait for the cleaner, otherwise our write of the newer content could be
+ * overtaken by its write of the older one. Caller must hold latch_ through
+ * lock, it may be released while waiting.
+ */
+Page *BufferPoolManager::ClaimFrame(BufferAccessStrategy *strategy,
+                                    std::unique_lock<std::mutex> &lock) {
+  while (true) {
+    Page *page = nullptr;
+    if (strategy != nullptr) {
+      page = GetRingFrame(strategy);
+    }
+    if (page == nullptr) {
+      page = GetVictimFrame();
+    }
+    if (page == nullptr) {
       return nullptr;
     }
-    LOG_INFO("page id %s is victim page, removed!", std::to_string(res->page_id_).c_str());
+    if (!page->is_dirty_) {
+      return page;
+    }
+    // a foreground write: the cleaner is falling behind
+    if (cleaner_running_) {
+      cleaner_cv_.notify_one();
+    }
+    if (write_back_.count(page->page_id_) == 0) {
+      return page;
+    }
+    ReleaseFrame(page);
+    write_back_cv_.wait(lock);
+  }
+}
+
+/*
+ * Reuse the frame of a page the scan brought in earlier: starting at the
+ * hand, the first ring page that is still resident and unpinned gives up its
+ * frame, which leaves the hand on that slot. Return nullptr while the ring is
+ * still filling up or has nothing to recycle. Caller must hold latch_.
+ */
+Page *BufferPoolManager::GetRingFrame(BufferAccessStrategy *strategy) {
+  std::lock_guard<std::mutex> ring_lock(strategy->latch_);
+  size_t ring_size = strategy->ring_.size();
+  // slots are filled in order, an empty slot at the hand means the ring has
+  // not reached its size yet
+  if (strategy->ring_[strategy->hand_] == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < ring_size; ++i) {
+    size_t slot = (strategy->hand_ + i) % ring_size;
+    Page *page = nullptr;
+    if (!FindPage(strategy->ring_[slot], page) || !ClaimUnpinned(page)) {
+      continue;
+    }
+    // the ring reuses the frame, its page leaves no history behind
+    ReplacerOf(page)->Remove(page);
+    strategy->hand_ = slot;
+    return page;
+  }
+  return nullptr;
+}
+
+/*
+ * The page takes over the ring slot the hand is on, whether its frame came
+ * from the ring or not. Caller must hold latch_.
+ */
+void BufferPoolManager::AddToRing(BufferAccessStrategy *strategy,
+                                  page_id_t page_id) {
+  std::lock_guard<std::mutex> ring_lock(strategy->latch_);
+  strategy->ring_[strategy->hand_] = page_id;
+  strategy->hand_ = (strategy->hand_ + 1) % strategy->ring_.size();
+}
+
+/*
+ * Count where the frame for a new page came from: a frame without a page is
+ * from the free list, any other was evicted from the replacer or a ring
+ */
+void BufferPoolManager::CountVictim(page_id_t old_page_id, bool write_back) {
+  stats_.Add(old_page_id == INVALID_PAGE_ID ? StatsCounter::FREE_LIST_VICTIM
+                                            : StatsCounter::REPLACER_VICTIM);
+  if (write_back) {
+    stats_.Add(StatsCounter::DIRTY_WRITE_BACK);
+  }
+}
+
+/*
+ * Write the content of a frame to disk under the WAL rule: the log must be
+ * persistent up to the page LSN before the page itself is written.
+ * Called without latch_; the caller keeps the frame from being reused.
+ */
+void BufferPoolManager::WriteBack(page_id_t page_id, Page *page) {
+  if (ENABLE_LOGGING && log_manager_ != nullptr) {
+    log_manager_->WaitForPersistentLSN(page->GetLSN());
+  }
+  disk_manager_->WritePage(page_id, page->GetData());
+}
+
+/*
+ * Block until no other thread is doing I/O on this frame. Caller must hold
+ * latch_ through lock, it is released while waiting.
+ */
+void BufferPoolManager::WaitForIO(Page *page, std::unique_lock<std::mutex> &lock) {
+  while (page->io_in_progress_) {
+    page->latch_->io_cv_.wait(lock);
+  }
+}
+
+/*
+ * Mark the I/O on a frame done and wake up everyone waiting for it, or for
+ * the write-back of old_page_id (INVALID_PAGE_ID when there was none).
+ * Caller must hold latch_.
+ */
+void BufferPoolManager::FinishIO(Page *page, page_id_t old_page_id) {
+  page->io_in_progress_ = false;
+  page->latch_->io_cv_.notify_all();
+  if (old_page_id != INVALID_PAGE_ID) {
+    write_back_.erase(old_page_id);
+    write_back_cv_.notify_all();
+  }
+}
+
+/*
+ * Start the page cleaner. Calling it on a pool whose cleaner is already
+ * running does nothing
+ */
+void BufferPoolManager::RunCleanerThread(size_t clean_target,
+                                         size_t batch_size) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (cleaner_thread_ != nullptr || pool_size_ == 0) {
+    return;
+  }
+  cleaner_running_ = true;
+  cleaner_thread_ = new std::thread(&BufferPoolManager::CleanerLoop, this,
+                                    clean_target, batch_size);
+}
+
+/*
+ * Stop and join the page cleaner, if there is one
+ */
+void BufferPoolManager::StopCleanerThread() {
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    if (cleaner_thread_ == nullptr) {
+      return;
+    }
+    cleaner_running_ = false;
+    cleaner_cv_.notify_one();
+  }
+  cleaner_thread_->join();
+  delete cleaner_thread_;
+  cleaner_thread_ = nullptr;
+}
+
+/*
+ * Body of the page cleaner: one round every CLEANER_INTERVAL, or as soon as
+ * a foreground thread had to write a dirty victim itself
+ */
+void BufferPoolManager::CleanerLoop(size_t clean_target, size_t batch_size) {
+  char *buffer = new char[batch_size * PAGE_SIZE];
+  std::unique_lock<std::mutex> lock(latch_);
+  while (cleaner_running_) {
+    CleanPages(clean_target, batch_size, buffer, lock);
+    if (cleaner_running_) {
+      cleaner_cv_.wait_for(lock, CLEANER_INTERVAL);
+    }
+  }
+  lock.unlock();
+  delete[] buffer;
+}
+
+/*
+ * One round of the page cleaner. The clean_target coldest evictable frames
+ * (free frames count as clean) are checked, and up to batch_size dirty ones
+ * are written in page id order, every run of consecutive ids with one
+ * DiskManager::WritePages and a single sync at the end. Frames are
+ * unpinned, so nobody changes them while their content is copied under
+ * latch_. They are marked clean and stay evictable; their page ids go to
+ * write_back_ until the copies are on disk, which keeps readers of an
+ * evicted page from seeing the old content on disk. Pages whose LSN is not
+ * yet persistent are left for a later round (WAL), the log flush thread is
+ * woken up for them instead. Caller must hold latch_ through lock, it is
+ * released for the writes.
+ */
+void BufferPoolManager::CleanPages(size_t clean_target, size_t batch_size,
+                                   char *buffer,
+                                   std::unique_lock<std::mutex> &lock) {
+  if (free_list_->size() >= clean_target) {
+    return;
+  }
+  std::vector<Page *> candidates;
+  size_t num_candidates = clean_target - free_list_->size();
+  replacer_->EvictionCandidates(candidates, num_candidates);
+  if (candidates.size() < num_candidates) {
+    priority_replacer_->EvictionCandidates(
+        candidates, num_candidates - candidates.size());
+  }
+
+  std::vector<std::pair<page_id_t, char *>> batch;
+  bool wait_for_log = false;
+  for (auto page : candidates) {
+    if (batch.size() == batch_size) {
+      break;
+    }
+    if (!page->is_dirty_ || page->pin_count_ != 0 ||
+        write_back_.count(page->page_id_) != 0) {
+      continue;
+    }
+    if (ENABLE_LOGGING && log_manager_ != nullptr &&
+        page->GetLSN() > log_manager_->GetPersistentLSN()) {
+      wait_for_log = true;
+      continue;
+    }
+    // no hit may pin and change the page while it is copied
+    if (!ClaimUnpinned(page)) {
+      continue;
+    }
+    char *copy = buffer + batch.size() * PAGE_SIZE;
+    memcpy(copy, page->GetData(), PAGE_SIZE);
+    page->pin_count_ = 0;
+    page->is_dirty_ = false;
+    write_back_.insert(page->page_id_);
+    batch.emplace_back(page->page_id_, copy);
+  }
+  if (wait_for_log) {
+    log_manager_->wakeUpFlushThread();
+  }
+  if (batch.empty()) {
+    return;
+  }
+  std::sort(batch.begin(), batch.end());
+  stats_.Add(StatsCounter::CLEANER_WRITE_BACK, batch.size());
+  lock.unlock();
+
+  std::vector<const char *> run;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    run.push_back(batch[i].second);
+    if (i + 1 == batch.size() || batch[i + 1].first != batch[i].first + 1) {
+      disk_manager_->WritePages(batch[i].first - (run.size() - 1),
+                                run.size(), run.data());
+      run.clear();
+    }
+  }
+  disk_manager_->Sync();
+
+  lock.lock();
+  for (auto &entry : batch) {
+    write_back_.erase(entry.first);
+  }
+  write_back_cv_.notify_all();
+}
+
+/*
+ * Put num_frames new frames, all in one new arena, on the free list. Their
+ * frame ids follow the last arena still around, frame ids of arenas freed
+ * after it are reused. Caller must hold latch_ unless the pool is still
+ * being constructed.
+ */
+void BufferPoolManager::AddFrames(size_t num_frames) {
+  if (num_frames == 0) {
+    return;
+  }
+  frame_id_t first_frame_id = 0;
+  for (auto arena : arenas_) {
+    first_frame_id = std::max(first_frame_id, arena->GetEndFrameId());
+  }
+  auto arena = new FrameArena(num_frames, first_frame_id);
+  arenas_.push_back(arena);
+  std::atomic<Page *> *frames = frames_.load(std::memory_order_relaxed);
+  size_t num_frame_ids = first_frame_id + num_frames;
+  if (num_frame_ids > num_frame_ids_) {
+    // a hit may still be reading the old array
+    auto grown = new std::atomic<Page *>[num_frame_ids];
+    for (size_t frame_id = 0; frame_id < num_frame_ids; ++frame_id) {
+      grown[frame_id] = frame_id < num_frame_ids_
+                            ? frames[frame_id].load(std::memory_order_relaxed)
+                            : nullptr;
+    }
+    if (frames != nullptr) {
+      retired_frames_.push_back(frames);
+    }
+    frames = grown;
+    num_frame_ids_ = num_frame_ids;
   }
+  for (frame_id_t frame_id = first_frame_id;
+       frame_id < arena->GetEndFrameId(); ++frame_id) {
+    frames[frame_id] = arena->GetFrame(frame_id);
+    free_list_->push_back(arena->GetFrame(frame_id));
+  }
+  frames_.store(frames, std::memory_order_release);
+}
 
-  assert(res->pin_count_ == 0);
-    
-  if (res->is_dirty_) {
-    if (ENABLE_LOGGING) {
-      while (res->GetLSN() > log_manager_->GetPersistentLSN()) {
-        log_manager_->wakeUpFlushThread();
+/*
+ * Grow or shrink the pool to new_size frames without stopping it. Growing
+ * puts frames on the free list, first the frames an earlier shrink took from
+ * arenas still around, then a new arena for the rest. Shrinking takes frames
+ * away the way a miss claims one, free list first, then victims of the
+ * replacer, and frees them after writing back their dirty pages; while every
+ * frame left is pinned it waits for an unpin. Fetches carry on meanwhile and
+ * compete for the same frames. A size of 0 is refused.
+ */
+bool BufferPoolManager::Resize(size_t new_size) {
+  if (new_size == 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> resize_lock(resize_latch_);
+  std::unique_lock<std::mutex> lock(latch_);
+  if (new_size >= pool_size_) {
+    page_table_->Reserve(new_size);
+    // frames a shrink took from arenas that are still around come back
+    // first, the rest is a new arena
+    for (auto arena : arenas_) {
+      for (frame_id_t frame_id = arena->GetFirstFrameId();
+           frame_id < arena->GetEndFrameId() && pool_size_ < new_size;
+           ++frame_id) {
+        std::atomic<Page *> &frame =
+            frames_.load(std::memory_order_relaxed)[frame_id];
+        if (frame == nullptr) {
+          frame = arena->GetFrame(frame_id);
+          free_list_->push_back(arena->GetFrame(frame_id));
+          arena->live_frames_++;
+          pool_size_++;
+        }
       }
     }
-    disk_manager_->WritePage(res->page_id_, res->GetData());
-    res->is_dirty_ = false;
+    size_t num_frames = new_size - pool_size_;
+    pool_size_ = new_size;
+    AddFrames(num_frames);
+    return true;
   }
 
-  page_table_->Remove(res->page_id_);
+  shrinking_ = true;
+  while (pool_size_ > new_size) {
+    Page *page = ClaimFrame(nullptr, lock);
+    if (page == nullptr) {
+      unpin_cv_.wait(lock);
+      continue;
+    }
+    DropFrame(page, lock);
+  }
+  shrinking_ = false;
+  return true;
+}
 
-  page_id = disk_manager_->AllocatePage();
-  page_table_->Insert(page_id, res);
-  
-  res->page_id_ = page_id;
-  res->is_dirty_ = false;
-  res->pin_count_ = 1;
-  res->ResetMemory();  
-  
-  return res;
+/*
+ * Look up the frame holding page_id. Caller must hold latch_, which keeps
+ * the frame from being taken by Resize; a hit without the latch goes
+ * through PinResident instead.
+ */
+bool BufferPoolManager::FindPage(page_id_t page_id, Page *&page) {
+  frame_id_t frame_id;
+  if (!page_table_->Find(page_id, frame_id)) {
+    return false;
+  }
+  page = frames_.load(std::memory_order_relaxed)[frame_id];
+  return true;
 }
 
 } // namespace cmudb
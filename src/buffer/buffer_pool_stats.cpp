@@ -0,0 +1,143 @@
+/**
+ * buffer_pool_stats.cpp
+ */
+#include "buffer/buffer_pool_stats.h"
+
+namespace cmudb {
+
+BufferPoolStats::BufferPoolStats() : enabled_(true) { Reset(); }
+
+/*
+ * Threads get their stripe round-robin on their first update, so up to
+ * STATS_STRIPES threads each have a stripe of their own, in every pool
+ */
+BufferPoolStats::Stripe &BufferPoolStats::GetStripe() {
+  static std::atomic<size_t> next_stripe(0);
+  static thread_local size_t stripe =
+      next_stripe.fetch_add(1, std::memory_order_relaxed) % STATS_STRIPES;
+  return stripes_[stripe];
+}
+
+void BufferPoolStats::RecordLatency(
+    StatsHistogram histogram, std::chrono::steady_clock::time_point start) {
+  if (!IsEnabled() || start == std::chrono::steady_clock::time_point()) {
+    return;
+  }
+  uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+  // number of significant bits: ns < 2^bucket
+  size_t bucket = ns == 0 ? 0 : 64 - __builtin_clzll(ns);
+  if (bucket >= STATS_LATENCY_BUCKETS) {
+    bucket = STATS_LATENCY_BUCKETS - 1;
+  }
+  GetStripe()
+      .histograms_[static_cast<size_t>(histogram)][bucket]
+      .fetch_add(1, std::memory_order_relaxed);
+}
+
+BufferPoolStatsSnapshot BufferPoolStats::Snapshot() const {
+  uint64_t counters[static_cast<size_t>(StatsCounter::NUM_COUNTERS)] = {};
+  BufferPoolStatsSnapshot snapshot;
+  LatencyHistogram *histograms[] = {&snapshot.fetch_hit_latency,
+                                    &snapshot.fetch_miss_latency};
+  for (const auto &stripe : stripes_) {
+    for (size_t i = 0; i < static_cast<size_t>(StatsCounter::NUM_COUNTERS);
+         ++i) {
+      counters[i] += stripe.counters_[i].load(std::memory_order_relaxed);
+    }
+    for (size_t h = 0;
+         h < static_cast<size_t>(StatsHistogram::NUM_HISTOGRAMS); ++h) {
+      for (size_t b = 0; b < STATS_LATENCY_BUCKETS; ++b) {
+        (*histograms[h])[b] +=
+            stripe.histograms_[h][b].load(std::memory_order_relaxed);
+      }
+    }
+  }
+  snapshot.hits = counters[static_cast<size_t>(StatsCounter::HIT)];
+  snapshot.misses = counters[static_cast<size_t>(StatsCounter::MISS)];
+  snapshot.free_list_victims =
+      counters[static_cast<size_t>(StatsCounter::FREE_LIST_VICTIM)];
+  snapshot.replacer_victims =
+      counters[static_cast<size_t>(StatsCounter::REPLACER_VICTIM)];
+  snapshot.dirty_write_backs =
+      counters[static_cast<size_t>(StatsCounter::DIRTY_WRITE_BACK)];
+  snapshot.cleaner_write_backs =
+      counters[static_cast<size_t>(StatsCounter::CLEANER_WRITE_BACK)];
+  snapshot.new_pages = counters[static_cast<size_t>(StatsCounter::NEW_PAGE)];
+  snapshot.delete_pages =
+      counters[static_cast<size_t>(StatsCounter::DELETE_PAGE)];
+  snapshot.pin_failures =
+      counters[static_cast<size_t>(StatsCounter::PIN_FAILURE)];
+  snapshot.compressed_tier_hits =
+      counters[static_cast<size_t>(StatsCounter::COMPRESSED_TIER_HIT)];
+  snapshot.victim_cache_hits =
+      counters[static_cast<size_t>(StatsCounter::VICTIM_CACHE_HIT)];
+  return snapshot;
+}
+
+/*
+ * Zero all stripes. Updates racing with a reset may survive it
+ */
+void BufferPoolStats::Reset() {
+  for (auto &stripe : stripes_) {
+    for (auto &counter : stripe.counters_) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+    for (auto &histogram : stripe.histograms_) {
+      for (auto &bucket : histogram) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+double BufferPoolStatsSnapshot::HitRatio() const {
+  uint64_t fetches = hits + misses;
+  return fetches == 0 ? 0 : static_cast<double>(hits) / fetches;
+}
+
+uint64_t BufferPoolStatsSnapshot::Percentile(const LatencyHistogram &histogram,
+                                             double p) {
+  uint64_t total = 0;
+  for (auto count : histogram) {
+    total += count;
+  }
+  if (total == 0) {
+    return 0;
+  }
+  uint64_t rank = static_cast<uint64_t>(p * total);
+  if (rank == 0) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (size_t b = 0; b < histogram.size(); ++b) {
+    seen += histogram[b];
+    if (seen >= rank) {
+      return 1ULL << b;
+    }
+  }
+  return 1ULL << (histogram.size() - 1);
+}
+
+BufferPoolStatsSnapshot &BufferPoolStatsSnapshot::
+operator+=(const BufferPoolStatsSnapshot &other) {
+  hits += other.hits;
+  misses += other.misses;
+  free_list_victims += other.free_list_victims;
+  replacer_victims += other.replacer_victims;
+  dirty_write_backs += other.dirty_write_backs;
+  cleaner_write_backs += other.cleaner_write_backs;
+  new_pages += other.new_pages;
+  delete_pages += other.delete_pages;
+  pin_failures += other.pin_failures;
+  compressed_tier_hits += other.compressed_tier_hits;
+  victim_cache_hits += other.victim_cache_hits;
+  for (size_t b = 0; b < STATS_LATENCY_BUCKETS; ++b) {
+    fetch_hit_latency[b] += other.fetch_hit_latency[b];
+    fetch_miss_latency[b] += other.fetch_miss_latency[b];
+  }
+  return *this;
+}
+
+} // namespace cmudb
@@ -0,0 +1,91 @@
+/**
+ * buffer_pool_trace.cpp
+ */
+#include <cstring>
+
+#include "buffer/buffer_pool_trace.h"
+
+namespace cmudb {
+
+BufferPoolTrace::BufferPoolTrace() : enabled_(false) {}
+
+BufferPoolTrace::~BufferPoolTrace() { Stop(); }
+
+bool BufferPoolTrace::Start(const std::string &file_name) {
+  Stop();
+  std::lock_guard<std::mutex> lock(latch_);
+  file_.open(file_name, std::ios::binary | std::ios::out | std::ios::trunc);
+  if (!file_.is_open()) {
+    file_.clear();
+    return false;
+  }
+  file_.write(TRACE_MAGIC, strlen(TRACE_MAGIC));
+  buffer_.reserve(TRACE_BUFFER_RECORDS);
+  start_ = std::chrono::steady_clock::now();
+  enabled_.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+void BufferPoolTrace::Stop() {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (!enabled_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  enabled_.store(false, std::memory_order_relaxed);
+  WriteBuffer();
+  file_.close();
+}
+
+/*
+ * Calls racing with Stop may be recorded or not, the flag is checked again
+ * under the latch so nothing is written after the file is closed
+ */
+void BufferPoolTrace::Record(TraceOp op, page_id_t page_id, bool flag) {
+  static std::atomic<uint16_t> next_thread(0);
+  static thread_local uint16_t thread =
+      next_thread.fetch_add(1, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(latch_);
+  if (!enabled_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  TraceRecord record;
+  record.time_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start_)
+                        .count();
+  record.page_id_ = page_id;
+  record.thread_ = thread;
+  record.op_ = op;
+  record.flag_ = flag;
+  buffer_.push_back(record);
+  if (buffer_.size() == TRACE_BUFFER_RECORDS) {
+    WriteBuffer();
+  }
+}
+
+/*
+ * Caller must hold latch_
+ */
+void BufferPoolTrace::WriteBuffer() {
+  file_.write(reinterpret_cast<const char *>(buffer_.data()),
+              buffer_.size() * sizeof(TraceRecord));
+  buffer_.clear();
+}
+
+bool BufferPoolTrace::Read(const std::string &file_name,
+                           std::vector<TraceRecord> &records) {
+  std::ifstream file(file_name, std::ios::binary | std::ios::in);
+  char magic[sizeof(TRACE_MAGIC)] = {};
+  if (!file.read(magic, strlen(TRACE_MAGIC)) ||
+      strcmp(magic, TRACE_MAGIC) != 0) {
+    return false;
+  }
+  records.clear();
+  TraceRecord record;
+  while (file.read(reinterpret_cast<char *>(&record), sizeof(record))) {
+    records.push_back(record);
+  }
+  // a partial record at the end is from a writer that did not finish
+  return true;
+}
+
+} // namespace cmudb
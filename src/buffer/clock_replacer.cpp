@@ -0,0 +1,111 @@
+/**
+ * CLOCK implementation
+ */
+#include "buffer/clock_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+/*
+ * slot of a value in the clock: frames use their frame id, plain integers
+ * (tests) are their own slot
+ */
+static inline size_t SlotOf(Page *const &page) { return page->GetFrameId(); }
+static inline size_t SlotOf(const int &value) { return value; }
+
+template <typename T>
+ClockReplacer<T>::ClockReplacer(size_t num_frames)
+    : slots_(num_frames), hand_(0), size_(0) {}
+
+template <typename T> ClockReplacer<T>::~ClockReplacer() {}
+
+/*
+ * Make value a candidate for eviction and give it a second chance. Inserting
+ * a value that is already in the replacer only sets its reference bit
+ */
+template <typename T> void ClockReplacer<T>::Insert(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t slot = SlotOf(value);
+  if (slot >= slots_.size()) {
+    slots_.resize(slot + 1);
+  }
+  Slot &s = slots_[slot];
+  if (!s.in_replacer_) {
+    s.in_replacer_ = true;
+    s.value_ = value;
+    size_++;
+  }
+  s.referenced_ = true;
+}
+
+/*
+ * Sweep the clock hand: referenced slots lose their reference bit and are
+ * skipped, the first unreferenced one is the victim. Terminates within two
+ * sweeps. Return false if the replacer is empty
+ */
+template <typename T> bool ClockReplacer<T>::Victim(T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (size_ == 0) {
+    return false;
+  }
+  while (true) {
+    Slot &s = slots_[hand_];
+    hand_ = (hand_ + 1) % slots_.size();
+    if (!s.in_replacer_) {
+      continue;
+    }
+    if (s.referenced_) {
+      s.referenced_ = false;
+      continue;
+    }
+    s.in_replacer_ = false;
+    size_--;
+    value = s.value_;
+    return true;
+  }
+}
+
+/*
+ * Remove value from the replacer. If removal is successful, return true,
+ * otherwise return false
+ */
+template <typename T> bool ClockReplacer<T>::Erase(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t slot = SlotOf(value);
+  if (slot >= slots_.size() || !slots_[slot].in_replacer_) {
+    return false;
+  }
+  slots_[slot].in_replacer_ = false;
+  slots_[slot].referenced_ = false;
+  size_--;
+  return true;
+}
+
+template <typename T> size_t ClockReplacer<T>::Size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+/*
+ * Unreferenced slots in the order the hand reaches them, then the
+ * referenced ones, which the hand reaches after clearing their bit
+ */
+template <typename T>
+void ClockReplacer<T>::EvictionCandidates(std::vector<T> &values, size_t n) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (int pass = 0; pass < 2; ++pass) {
+    for (size_t i = 0; i < slots_.size() && n > 0; ++i) {
+      Slot &s = slots_[(hand_ + i) % slots_.size()];
+      if (s.in_replacer_ && s.referenced_ == (pass == 1)) {
+        values.push_back(s.value_);
+        n--;
+      }
+    }
+  }
+}
+
+template class ClockReplacer<Page *>;
+// slots of the victim cache, and tests
+template class ClockReplacer<int>;
+
+} // namespace cmudb
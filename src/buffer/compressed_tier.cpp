@@ -0,0 +1,116 @@
+/**
+ * compressed_tier.cpp
+ */
+#include <cassert>
+#include <iterator>
+#include <vector>
+
+#include "buffer/compressed_tier.h"
+#include "common/lz_codec.h"
+
+namespace cmudb {
+
+// bookkeeping charged to every entry on top of its compressed data: list
+// node, hash table node and string
+#define TIER_ENTRY_OVERHEAD 96
+
+CompressedTier::CompressedTier(size_t budget) : budget_(budget), usage_(0) {}
+
+void CompressedTier::SetBudget(size_t budget) {
+  std::lock_guard<std::mutex> lock(latch_);
+  budget_ = budget;
+  Shrink();
+}
+
+/*
+ * Compression happens outside of latch_, only the bookkeeping is under it
+ */
+bool CompressedTier::Put(page_id_t page_id, const char *data,
+                         std::vector<Entry> *dropped) {
+  if (!IsEnabled()) {
+    return false;
+  }
+  // worth keeping only if it saves an eighth of the page
+  int capacity = PAGE_SIZE - PAGE_SIZE / 8;
+  std::vector<char> buffer(capacity);
+  int size = LZCodec::Compress(data, PAGE_SIZE, buffer.data(), capacity);
+
+  std::lock_guard<std::mutex> lock(latch_);
+  auto it = index_.find(page_id);
+  if (it != index_.end()) {
+    EraseEntry(it->second);
+  }
+  if (size == 0 ||
+      static_cast<size_t>(size) + TIER_ENTRY_OVERHEAD > budget_) {
+    return false;
+  }
+  entries_.push_front(Entry{page_id, std::string(buffer.data(), size)});
+  index_[page_id] = entries_.begin();
+  usage_ += size + TIER_ENTRY_OVERHEAD;
+  Shrink(dropped);
+  return true;
+}
+
+bool CompressedTier::Take(page_id_t page_id, char *data) {
+  Entry entry;
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    auto it = index_.find(page_id);
+    if (it == index_.end()) {
+      return false;
+    }
+    entry = *it->second;
+    EraseEntry(it->second);
+  }
+  return Decompress(entry, data);
+}
+
+void CompressedTier::Erase(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto it = index_.find(page_id);
+  if (it != index_.end()) {
+    EraseEntry(it->second);
+  }
+}
+
+bool CompressedTier::Decompress(const Entry &entry, char *data) {
+  int size = LZCodec::Decompress(entry.data_.data(), entry.data_.size(), data,
+                                 PAGE_SIZE);
+  assert(size == PAGE_SIZE);
+  return size == PAGE_SIZE;
+}
+
+size_t CompressedTier::GetMemoryUsage() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return usage_;
+}
+
+size_t CompressedTier::GetNumPages() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return entries_.size();
+}
+
+/*
+ * Caller must hold latch_
+ */
+void CompressedTier::EraseEntry(std::list<Entry>::iterator entry) {
+  usage_ -= entry->data_.size() + TIER_ENTRY_OVERHEAD;
+  index_.erase(entry->page_id_);
+  entries_.erase(entry);
+}
+
+/*
+ * Drop the least recently put pages until usage_ is within budget_, into
+ * dropped if given. Caller must hold latch_
+ */
+void CompressedTier::Shrink(std::vector<Entry> *dropped) {
+  while (usage_ > budget_) {
+    auto entry = std::prev(entries_.end());
+    if (dropped != nullptr) {
+      dropped->push_back(*entry);
+    }
+    EraseEntry(entry);
+  }
+}
+
+} // namespace cmudb
@@ -0,0 +1,87 @@
+/**
+ * frame_arena.cpp
+ */
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <new>
+
+#include "buffer/frame_arena.h"
+
+namespace cmudb {
+
+static size_t RoundUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+FrameArena::FrameArena(size_t num_frames, frame_id_t first_frame_id)
+    : live_frames_(num_frames), num_frames_(num_frames),
+      first_frame_id_(first_frame_id), data_(nullptr), huge_pages_(false) {
+  size_t size = num_frames_ * PAGE_SIZE;
+  void *memory = MAP_FAILED;
+  // below one huge page, a huge page would mostly be wasted
+  if (size >= HUGE_PAGE_SIZE) {
+    mapped_size_ = RoundUp(size, HUGE_PAGE_SIZE);
+#ifdef MAP_HUGETLB
+    if (FRAME_ARENA_HUGETLB) {
+      memory = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+    if (memory != MAP_FAILED) {
+      huge_pages_ = true;
+    } else {
+      // no huge pages reserved: ask for transparent ones instead
+      memory = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+      if (memory != MAP_FAILED) {
+        huge_pages_ = madvise(memory, mapped_size_, MADV_HUGEPAGE) == 0;
+      }
+#endif
+    }
+  } else {
+    mapped_size_ = RoundUp(size, sysconf(_SC_PAGESIZE));
+    memory = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  if (memory == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  // anonymous memory is zero filled, no ResetMemory needed
+  data_ = static_cast<char *>(memory);
+  // new does not align beyond max_align_t before C++17
+  void *metadata = nullptr;
+  if (posix_memalign(&metadata, CACHE_LINE_SIZE,
+                     num_frames_ * sizeof(Page)) != 0) {
+    munmap(data_, mapped_size_);
+    throw std::bad_alloc();
+  }
+  frames_ = static_cast<Page *>(metadata);
+  latches_ = new FrameLatch[num_frames_];
+  for (size_t i = 0; i < num_frames_; ++i) {
+    new (&frames_[i]) Page();
+    frames_[i].data_ = data_ + i * PAGE_SIZE;
+    frames_[i].latch_ = &latches_[i];
+    frames_[i].frame_id_ = first_frame_id_ + i;
+  }
+}
+
+FrameArena::~FrameArena() {
+  for (size_t i = 0; i < num_frames_; ++i) {
+    frames_[i].~Page();
+  }
+  free(frames_);
+  delete[] latches_;
+  ReleaseData();
+}
+
+void FrameArena::ReleaseData() {
+  if (data_ != nullptr) {
+    munmap(data_, mapped_size_);
+    data_ = nullptr;
+  }
+}
+
+} // namespace cmudb
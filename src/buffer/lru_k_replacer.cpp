@@ -0,0 +1,206 @@
+/**
+ * LRU-K implementation
+ */
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <tuple>
+
+#include "buffer/lru_k_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+/*
+ * slot of a value: frames use their frame id, plain integers (tests) are
+ * their own slot. The key tells whether the history in a slot still belongs
+ * to the page now held by the frame
+ */
+static inline size_t SlotOf(Page *const &page) { return page->GetFrameId(); }
+static inline size_t SlotOf(const int &value) { return value; }
+static inline page_id_t KeyOf(Page *const &page) { return page->GetPageId(); }
+static inline page_id_t KeyOf(const int &value) { return value; }
+
+template <typename T>
+LRUKReplacer<T>::LRUKReplacer(size_t k, size_t num_frames)
+    : k_(k), slots_(num_frames), current_timestamp_(0), size_(0) {
+  assert(k_ > 0);
+}
+
+template <typename T> LRUKReplacer<T>::~LRUKReplacer() {}
+
+/*
+ * Find the slot of value, growing the array if needed and dropping history
+ * left behind by another page. Caller must hold mutex_
+ */
+template <typename T>
+typename LRUKReplacer<T>::Slot &LRUKReplacer<T>::GetSlot(const T &value) {
+  size_t slot = SlotOf(value);
+  if (slot >= slots_.size()) {
+    slots_.resize(slot + 1);
+  }
+  Slot &s = slots_[slot];
+  if (s.key_ != KeyOf(value)) {
+    s.key_ = KeyOf(value);
+    s.accesses_ = 0;
+  }
+  s.value_ = value;
+  return s;
+}
+
+template <typename T> void LRUKReplacer<T>::Access(Slot &slot) {
+  if (slot.history_.size() != k_) {
+    slot.history_.resize(k_);
+  }
+  slot.history_[slot.accesses_ % k_] = current_timestamp_++;
+  slot.accesses_++;
+}
+
+/*
+ * Record an access to value, which is now pinned and no longer a candidate
+ * for eviction
+ */
+template <typename T> void LRUKReplacer<T>::RecordAccess(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Slot &s = GetSlot(value);
+  Access(s);
+  if (s.in_replacer_) {
+    s.in_replacer_ = false;
+    size_--;
+  }
+}
+
+/*
+ * Make value a candidate for eviction. A value that was never accessed gets
+ * one access now, so the replacer also works for callers that only use
+ * Insert/Erase
+ */
+template <typename T> void LRUKReplacer<T>::Insert(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Slot &s = GetSlot(value);
+  if (s.accesses_ == 0) {
+    Access(s);
+  }
+  if (!s.in_replacer_) {
+    s.in_replacer_ = true;
+    size_++;
+  }
+}
+
+/*
+ * Evict the frame with the largest backward K-distance. Frames with fewer
+ * than K accesses win over all others, ties are broken by the oldest
+ * recorded access. The history of the victim is dropped. Return false if the
+ * replacer is empty
+ */
+template <typename T> bool LRUKReplacer<T>::Victim(T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (size_ == 0) {
+    return false;
+  }
+  Slot *victim = nullptr;
+  bool victim_infinite = false;
+  size_t victim_timestamp = std::numeric_limits<size_t>::max();
+  for (auto &s : slots_) {
+    if (!s.in_replacer_) {
+      continue;
+    }
+    bool infinite = s.accesses_ < k_;
+    // oldest access still in the window: the k-th most recent one once the
+    // ring is full, the very first one before that
+    size_t timestamp = s.history_[infinite ? 0 : s.accesses_ % k_];
+    if (victim == nullptr || (infinite && !victim_infinite) ||
+        (infinite == victim_infinite && timestamp < victim_timestamp)) {
+      victim = &s;
+      victim_infinite = infinite;
+      victim_timestamp = timestamp;
+    }
+  }
+  assert(victim != nullptr);
+  // the history stays until another page takes the slot, see Restore
+  victim->in_replacer_ = false;
+  victim->key_ = INVALID_PAGE_ID;
+  size_--;
+  value = victim->value_;
+  return true;
+}
+
+/*
+ * Remove value from the set of eviction candidates, its history is kept. If
+ * removal is successful, return true, otherwise return false
+ */
+template <typename T> bool LRUKReplacer<T>::Erase(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t slot = SlotOf(value);
+  if (slot >= slots_.size() || !slots_[slot].in_replacer_) {
+    return false;
+  }
+  slots_[slot].in_replacer_ = false;
+  size_--;
+  return true;
+}
+
+/*
+ * Drop value and its history, its page is gone from the frame
+ */
+template <typename T> void LRUKReplacer<T>::Remove(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t slot = SlotOf(value);
+  if (slot >= slots_.size()) {
+    return;
+  }
+  Slot &s = slots_[slot];
+  if (s.in_replacer_) {
+    s.in_replacer_ = false;
+    size_--;
+  }
+  s.key_ = INVALID_PAGE_ID;
+  s.accesses_ = 0;
+}
+
+/*
+ * Undo Victim: the slot gets its page back and with it the history Victim
+ * left in place, not evictable while the page is pinned
+ */
+template <typename T> void LRUKReplacer<T>::Restore(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t slot = SlotOf(value);
+  if (slot < slots_.size() && slots_[slot].key_ == INVALID_PAGE_ID) {
+    slots_[slot].key_ = KeyOf(value);
+  }
+}
+
+template <typename T> size_t LRUKReplacer<T>::Size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+/*
+ * Same order as Victim: infinite distances first, then by oldest access
+ * still in the window
+ */
+template <typename T>
+void LRUKReplacer<T>::EvictionCandidates(std::vector<T> &values, size_t n) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // (finite distance, timestamp, slot)
+  std::vector<std::tuple<bool, size_t, size_t>> order;
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    const Slot &s = slots_[i];
+    if (s.in_replacer_) {
+      bool infinite = s.accesses_ < k_;
+      order.emplace_back(!infinite, s.history_[infinite ? 0 : s.accesses_ % k_],
+                         i);
+    }
+  }
+  n = std::min(n, order.size());
+  std::partial_sort(order.begin(), order.begin() + n, order.end());
+  for (size_t i = 0; i < n; ++i) {
+    values.push_back(slots_[std::get<2>(order[i])].value_);
+  }
+}
+
+template class LRUKReplacer<Page *>;
+// test only
+template class LRUKReplacer<int>;
+
+} // namespace cmudb
@@ -65,6 +65,18 @@ template <typename T> size_t LRUReplacer<T>::Size() {
   return itemMap_.size(); 
 }
 
+/*
+ * The tail of the list is evicted first
+ */
+template <typename T>
+void LRUReplacer<T>::EvictionCandidates(std::vector<T> &values, size_t n) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = itemList_.rbegin(); it != itemList_.rend() && n > 0;
+       ++it, --n) {
+    values.push_back(*it);
+  }
+}
+
 template class LRUReplacer<Page *>;
 // test only
 template class LRUReplacer<int>;
@@ -0,0 +1,72 @@
+/**
+ * page_guard.cpp
+ */
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/page_guard.h"
+
+namespace cmudb {
+
+ReadPageGuard::ReadPageGuard(ReadPageGuard &&other) noexcept
+    : bpm_(other.bpm_), page_(other.page_) {
+  other.page_ = nullptr;
+}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&other) noexcept {
+  if (this != &other) {
+    Release();
+    bpm_ = other.bpm_;
+    page_ = other.page_;
+    other.page_ = nullptr;
+  }
+  return *this;
+}
+
+void ReadPageGuard::Release() {
+  if (page_ == nullptr) {
+    return;
+  }
+  page_->RUnlatch();
+  bpm_->UnpinFrame(page_, false);
+  page_ = nullptr;
+}
+
+WritePageGuard ReadPageGuard::TryUpgrade() {
+  if (page_ == nullptr || !page_->TryUpgradeLatch()) {
+    return WritePageGuard();
+  }
+  WritePageGuard guard(bpm_, page_);
+  page_ = nullptr;
+  return guard;
+}
+
+WritePageGuard::WritePageGuard(WritePageGuard &&other) noexcept
+    : bpm_(other.bpm_), page_(other.page_), is_dirty_(other.is_dirty_) {
+  other.page_ = nullptr;
+  other.is_dirty_ = false;
+}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&other) noexcept {
+  if (this != &other) {
+    Release();
+    bpm_ = other.bpm_;
+    page_ = other.page_;
+    is_dirty_ = other.is_dirty_;
+    other.page_ = nullptr;
+    other.is_dirty_ = false;
+  }
+  return *this;
+}
+
+void WritePageGuard::Release() {
+  if (page_ == nullptr) {
+    return;
+  }
+  page_->WUnlatch();
+  bpm_->UnpinFrame(page_, is_dirty_);
+  page_ = nullptr;
+  is_dirty_ = false;
+}
+
+} // namespace cmudb
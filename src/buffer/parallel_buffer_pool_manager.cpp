@@ -0,0 +1,325 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+namespace cmudb {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances,
+                                                     size_t pool_size,
+                                                     DiskManager *disk_manager,
+                                                     LogManager *log_manager,
+                                                     ReplacerType replacer_type,
+                                                     size_t replacer_k)
+    : disk_manager_(disk_manager), parked_page_ids_(num_instances),
+      num_parked_(0) {
+  assert(num_instances > 0);
+  for (size_t i = 0; i < num_instances; ++i) {
+    instances_.push_back(new BufferPoolManager(pool_size, disk_manager,
+                                               log_manager, replacer_type,
+                                               replacer_k));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto instance : instances_) {
+    delete instance;
+  }
+}
+
+/*
+ * Page ids are striped over the shards, so the owner of a page is fixed for
+ * its whole lifetime
+ */
+BufferPoolManager *ParallelBufferPoolManager::GetInstance(page_id_t page_id) {
+  return instances_[page_id % instances_.size()];
+}
+
+Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id,
+                                           AccessType access_type,
+                                           BufferAccessStrategy *strategy) {
+  Page *page = GetInstance(page_id)->FetchPage(page_id, access_type, strategy);
+  TraceCall(TraceOp::FETCH, page != nullptr ? page_id : INVALID_PAGE_ID,
+            access_type == AccessType::SEQUENTIAL_SCAN);
+  return page;
+}
+
+bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  TraceCall(TraceOp::UNPIN, page_id, is_dirty);
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::UnpinFrame(Page *page, bool is_dirty) {
+  TraceCall(TraceOp::UNPIN, page->GetPageId(), is_dirty);
+  return GetInstance(page->GetPageId())->UnpinFrame(page, is_dirty);
+}
+
+/*
+ * Split the request by shard and let every shard fetch its part as one
+ * batch. If a shard runs out of frames, the parts already pinned in the
+ * other shards are unpinned again
+ */
+bool ParallelBufferPoolManager::FetchPages(
+    const std::vector<page_id_t> &page_ids, std::vector<Page *> &pages,
+    AccessType access_type) {
+  size_t num_instances = instances_.size();
+  std::vector<std::vector<page_id_t>> shard_page_ids(num_instances);
+  std::vector<std::vector<size_t>> shard_indexes(num_instances);
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    shard_page_ids[page_ids[i] % num_instances].push_back(page_ids[i]);
+    shard_indexes[page_ids[i] % num_instances].push_back(i);
+  }
+  pages.assign(page_ids.size(), nullptr);
+  std::vector<Page *> shard_pages;
+  for (size_t i = 0; i < num_instances; ++i) {
+    if (shard_page_ids[i].empty()) {
+      continue;
+    }
+    if (!instances_[i]->FetchPages(shard_page_ids[i], shard_pages,
+                                   access_type)) {
+      for (size_t j = 0; j < i; ++j) {
+        instances_[j]->UnpinPages(
+            shard_page_ids[j],
+            std::vector<bool>(shard_page_ids[j].size(), false));
+      }
+      pages.assign(page_ids.size(), nullptr);
+      return false;
+    }
+    for (size_t j = 0; j < shard_pages.size(); ++j) {
+      pages[shard_indexes[i][j]] = shard_pages[j];
+    }
+  }
+  for (auto page_id : page_ids) {
+    TraceCall(TraceOp::FETCH, page_id,
+              access_type == AccessType::SEQUENTIAL_SCAN);
+  }
+  return true;
+}
+
+bool ParallelBufferPoolManager::UnpinPages(
+    const std::vector<page_id_t> &page_ids, const std::vector<bool> &is_dirty) {
+  size_t num_instances = instances_.size();
+  std::vector<std::vector<page_id_t>> shard_page_ids(num_instances);
+  std::vector<std::vector<bool>> shard_is_dirty(num_instances);
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    TraceCall(TraceOp::UNPIN, page_ids[i], is_dirty[i]);
+    shard_page_ids[page_ids[i] % num_instances].push_back(page_ids[i]);
+    shard_is_dirty[page_ids[i] % num_instances].push_back(is_dirty[i]);
+  }
+  bool all_unpinned = true;
+  for (size_t i = 0; i < num_instances; ++i) {
+    if (!shard_page_ids[i].empty()) {
+      all_unpinned =
+          instances_[i]->UnpinPages(shard_page_ids[i], shard_is_dirty[i]) &&
+          all_unpinned;
+    }
+  }
+  return all_unpinned;
+}
+
+bool ParallelBufferPoolManager::FlushPage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetInstance(page_id)->FlushPage(page_id);
+}
+
+/*
+ * Every shard writes and syncs its own pages
+ */
+size_t ParallelBufferPoolManager::FlushDirtyPages(
+    const std::function<bool(page_id_t)> &predicate) {
+  size_t flushed = 0;
+  for (auto instance : instances_) {
+    flushed += instance->FlushDirtyPages(predicate);
+  }
+  return flushed;
+}
+
+/*
+ * The disk manager allocates the page id, the shard owning it provides the
+ * frame. Consecutive ids land in consecutive shards, so new pages still go
+ * round-robin over the shards. If the owning shard has all of its frames
+ * pinned, the id is parked with that shard and the next id is tried, which
+ * belongs to the next shard. Parked ids are handed out first once their
+ * shard has a frame again, so no id is lost. Only if every shard is full is
+ * nullptr returned
+ */
+Page *ParallelBufferPoolManager::NewPage(page_id_t &page_id) {
+  page_id_t new_page_id;
+  Page *page = NewParkedPage(new_page_id);
+  for (size_t i = 0; page == nullptr && i < instances_.size(); ++i) {
+    new_page_id = disk_manager_->AllocatePage();
+    page = GetInstance(new_page_id)->CreatePage(new_page_id, false);
+    if (page == nullptr) {
+      ParkPageId(new_page_id);
+    }
+  }
+  if (page == nullptr) {
+    TraceCall(TraceOp::NEW, INVALID_PAGE_ID);
+    return nullptr;
+  }
+  page_id = new_page_id;
+  TraceCall(TraceOp::NEW, page_id);
+  return page;
+}
+
+void ParallelBufferPoolManager::ParkPageId(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(parked_latch_);
+  parked_page_ids_[page_id % instances_.size()].push_back(page_id);
+  num_parked_++;
+}
+
+/*
+ * Try the ids parked by earlier calls, the oldest of every shard. An id whose
+ * shard is still full goes back to its list
+ */
+Page *ParallelBufferPoolManager::NewParkedPage(page_id_t &page_id) {
+  if (num_parked_ == 0) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    {
+      std::lock_guard<std::mutex> lock(parked_latch_);
+      if (parked_page_ids_[i].empty()) {
+        continue;
+      }
+      page_id = parked_page_ids_[i].front();
+      parked_page_ids_[i].pop_front();
+      num_parked_--;
+    }
+    Page *page = instances_[i]->CreatePage(page_id, false);
+    if (page != nullptr) {
+      return page;
+    }
+    std::lock_guard<std::mutex> lock(parked_latch_);
+    parked_page_ids_[i].push_front(page_id);
+    num_parked_++;
+  }
+  return nullptr;
+}
+
+bool ParallelBufferPoolManager::DeletePage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  TraceCall(TraceOp::DELETE, page_id);
+  return GetInstance(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::PrefetchPage(
+    page_id_t page_id, std::shared_ptr<BufferAccessStrategy> strategy) {
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  GetInstance(page_id)->PrefetchPage(page_id, strategy);
+}
+
+/*
+ * Split the request by shard, so every shard queues its pages at once
+ */
+void ParallelBufferPoolManager::PrefetchPages(
+    const std::vector<page_id_t> &page_ids,
+    std::shared_ptr<BufferAccessStrategy> strategy) {
+  std::vector<std::vector<page_id_t>> shard_page_ids(instances_.size());
+  for (auto page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      shard_page_ids[page_id % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    if (!shard_page_ids[i].empty()) {
+      instances_[i]->PrefetchPages(shard_page_ids[i], strategy);
+    }
+  }
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+  size_t total = 0;
+  for (auto instance : instances_) {
+    total += instance->GetPoolSize();
+  }
+  return total;
+}
+
+/*
+ * Every shard keeps at least one frame, so a total below the number of
+ * shards is refused. All shards are resized even if one of them refuses,
+ * false tells that at least one kept its old size
+ */
+bool ParallelBufferPoolManager::Resize(size_t new_size) {
+  size_t num_instances = instances_.size();
+  if (new_size < num_instances) {
+    return false;
+  }
+  bool resized = true;
+  for (size_t i = 0; i < num_instances; ++i) {
+    size_t shard_size =
+        new_size / num_instances + (i < new_size % num_instances ? 1 : 0);
+    resized = instances_[i]->Resize(shard_size) && resized;
+  }
+  return resized;
+}
+
+BufferPoolStatsSnapshot ParallelBufferPoolManager::GetStats() {
+  BufferPoolStatsSnapshot total;
+  for (auto instance : instances_) {
+    total += instance->GetStats();
+  }
+  return total;
+}
+
+void ParallelBufferPoolManager::ResetStats() {
+  for (auto instance : instances_) {
+    instance->ResetStats();
+  }
+}
+
+void ParallelBufferPoolManager::SetStatsEnabled(bool enabled) {
+  for (auto instance : instances_) {
+    instance->SetStatsEnabled(enabled);
+  }
+}
+
+void ParallelBufferPoolManager::SetPagePriority(page_id_t page_id,
+                                                PagePriority priority) {
+  GetInstance(page_id)->SetPagePriority(page_id, priority);
+}
+
+bool ParallelBufferPoolManager::IsPageCached(page_id_t page_id) {
+  return GetInstance(page_id)->IsPageCached(page_id);
+}
+
+std::shared_ptr<MappedFile> ParallelBufferPoolManager::MapDatabaseFile() {
+  return instances_[0]->MapDatabaseFile();
+}
+
+void ParallelBufferPoolManager::SetCompressedTierBudget(size_t budget) {
+  for (auto instance : instances_) {
+    instance->SetCompressedTierBudget(budget / instances_.size());
+  }
+}
+
+bool ParallelBufferPoolManager::EnableVictimCache(const std::string &file_name,
+                                                  size_t num_pages) {
+  bool enabled = true;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    enabled = instances_[i]->EnableVictimCache(
+                  file_name + "." + std::to_string(i),
+                  num_pages / instances_.size()) &&
+              enabled;
+  }
+  return enabled;
+}
+
+void ParallelBufferPoolManager::RunCleanerThread(size_t clean_target,
+                                                 size_t batch_size) {
+  for (auto instance : instances_) {
+    instance->RunCleanerThread(clean_target, batch_size);
+  }
+}
+
+void ParallelBufferPoolManager::StopCleanerThread() {
+  for (auto instance : instances_) {
+    instance->StopCleanerThread();
+  }
+}
+
+} // namespace cmudb
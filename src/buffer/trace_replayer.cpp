@@ -0,0 +1,105 @@
+/**
+ * trace_replayer.cpp
+ */
+#include <cstdio>
+
+#include "buffer/trace_replayer.h"
+
+namespace cmudb {
+
+TraceReplayer::TraceReplayer(size_t pool_size, ReplacerType replacer_type,
+                             size_t replacer_k, const std::string &db_file)
+    : pool_size_(pool_size), replacer_type_(replacer_type),
+      replacer_k_(replacer_k), db_file_(db_file), first_unmapped_id_(0) {}
+
+/*
+ * Replayed id of a traced page, pages the trace did not create get ids past
+ * all the ones the replay's NewPage calls can hand out
+ */
+page_id_t TraceReplayer::MapPageId(page_id_t page_id) {
+  auto it = page_ids_.find(page_id);
+  if (it != page_ids_.end()) {
+    return it->second;
+  }
+  page_id_t replayed_id = first_unmapped_id_ + page_id;
+  page_ids_[page_id] = replayed_id;
+  return replayed_id;
+}
+
+ReplayResult TraceReplayer::Replay(const std::vector<TraceRecord> &records) {
+  page_ids_.clear();
+  pins_.clear();
+  first_unmapped_id_ = 0;
+  for (const auto &record : records) {
+    if (record.op_ == TraceOp::NEW) {
+      first_unmapped_id_++;
+    }
+  }
+
+  ReplayResult result;
+  std::string log_file = db_file_.substr(0, db_file_.find(".")) + ".log";
+  remove(db_file_.c_str());
+  DiskManager *disk_manager = new DiskManager(db_file_);
+  BufferPoolManager *bpm = new BufferPoolManager(
+      pool_size_, disk_manager, nullptr, replacer_type_, replacer_k_);
+
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &record : records) {
+    switch (record.op_) {
+    case TraceOp::FETCH: {
+      // failed when traced too
+      if (record.page_id_ == INVALID_PAGE_ID) {
+        break;
+      }
+      AccessType access_type = record.flag_ ? AccessType::SEQUENTIAL_SCAN
+                                            : AccessType::RANDOM;
+      if (bpm->FetchPage(MapPageId(record.page_id_), access_type) ==
+          nullptr) {
+        result.failed_calls_++;
+      } else {
+        pins_[record.page_id_]++;
+      }
+      break;
+    }
+    case TraceOp::NEW: {
+      // failed when traced too
+      if (record.page_id_ == INVALID_PAGE_ID) {
+        break;
+      }
+      page_id_t replayed_id;
+      if (bpm->NewPage(replayed_id) == nullptr) {
+        result.failed_calls_++;
+      } else {
+        page_ids_[record.page_id_] = replayed_id;
+        pins_[record.page_id_]++;
+      }
+      break;
+    }
+    case TraceOp::UNPIN: {
+      auto pins = pins_.find(record.page_id_);
+      if (pins != pins_.end() && pins->second > 0) {
+        bpm->UnpinPage(MapPageId(record.page_id_), record.flag_);
+        pins->second--;
+      }
+      break;
+    }
+    case TraceOp::DELETE:
+      bpm->DeletePage(MapPageId(record.page_id_));
+      break;
+    }
+  }
+  result.seconds_ = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+  result.stats_ = bpm->GetStats();
+  result.disk_reads_ = disk_manager->GetNumReads();
+  result.disk_write_requests_ = disk_manager->GetNumWriteRequests();
+  delete bpm;
+  delete disk_manager;
+  remove(db_file_.c_str());
+  remove(log_file.c_str());
+  return result;
+}
+
+} // namespace cmudb
@@ -0,0 +1,127 @@
+/**
+ * victim_cache.cpp
+ */
+#include "buffer/victim_cache.h"
+
+namespace cmudb {
+
+VictimCache::VictimCache(const std::string &file_name, size_t num_pages)
+    : cache_disk_manager_(file_name, num_pages),
+      slots_(num_pages, INVALID_PAGE_ID), states_(num_pages, SlotState::FREE),
+      replacer_(num_pages) {
+  for (size_t slot = num_pages; slot > 0; --slot) {
+    free_slots_.push_back(slot - 1);
+  }
+}
+
+/*
+ * Write the page into its old slot, a free one or the victim of the clock.
+ * The slot is picked under latch_, written without it
+ */
+void VictimCache::Put(page_id_t page_id, const char *data) {
+  std::unique_lock<std::mutex> lock(latch_);
+  int slot = -1;
+  auto it = index_.find(page_id);
+  if (it != index_.end()) {
+    if (states_[it->second] == SlotState::VALID) {
+      slot = it->second;
+      replacer_.Erase(slot);
+    } else {
+      // put again while its last put is still being written
+      DiscardSlot(it->second);
+    }
+  }
+  if (slot < 0) {
+    if (!free_slots_.empty()) {
+      slot = free_slots_.back();
+      free_slots_.pop_back();
+    } else if (replacer_.Victim(slot)) {
+      index_.erase(slots_[slot]);
+    } else {
+      return; // a cache without slots, or all of them under I/O
+    }
+  }
+  index_[page_id] = slot;
+  slots_[slot] = page_id;
+  states_[slot] = SlotState::WRITING;
+  lock.unlock();
+
+  cache_disk_manager_.WriteSlot(slot, data);
+
+  lock.lock();
+  if (states_[slot] == SlotState::DISCARDED) {
+    FreeSlot(slot);
+    return;
+  }
+  states_[slot] = SlotState::VALID;
+  replacer_.Insert(slot);
+}
+
+/*
+ * A page still being written is not there yet: it is dropped, the caller
+ * reads it from the database file, which has the same content
+ */
+bool VictimCache::Take(page_id_t page_id, char *data) {
+  std::unique_lock<std::mutex> lock(latch_);
+  auto it = index_.find(page_id);
+  if (it == index_.end()) {
+    return false;
+  }
+  int slot = it->second;
+  if (states_[slot] != SlotState::VALID) {
+    DiscardSlot(slot);
+    return false;
+  }
+  index_.erase(it);
+  replacer_.Erase(slot);
+  states_[slot] = SlotState::READING;
+  lock.unlock();
+
+  cache_disk_manager_.ReadSlot(slot, data);
+
+  lock.lock();
+  FreeSlot(slot);
+  return true;
+}
+
+void VictimCache::Erase(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto it = index_.find(page_id);
+  if (it == index_.end()) {
+    return;
+  }
+  int slot = it->second;
+  if (states_[slot] != SlotState::VALID) {
+    DiscardSlot(slot);
+    return;
+  }
+  index_.erase(it);
+  replacer_.Erase(slot);
+  FreeSlot(slot);
+}
+
+size_t VictimCache::GetNumPages() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return index_.size();
+}
+
+/*
+ * Put a slot that is neither in index_ nor in the clock back on the free
+ * list. Caller must hold latch_
+ */
+void VictimCache::FreeSlot(int slot) {
+  slots_[slot] = INVALID_PAGE_ID;
+  states_[slot] = SlotState::FREE;
+  free_slots_.push_back(slot);
+}
+
+/*
+ * Drop the page of a slot being written, whoever writes it frees the slot
+ * when done. Caller must hold latch_
+ */
+void VictimCache::DiscardSlot(int slot) {
+  index_.erase(slots_[slot]);
+  states_[slot] = SlotState::DISCARDED;
+}
+
+} // namespace cmudb
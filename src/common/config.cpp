@@ -4,4 +4,8 @@ namespace cmudb {
   std::atomic<bool> ENABLE_LOGGING(false);  // for virtual table
   std::chrono::duration<long long int> LOG_TIMEOUT =
    std::chrono::seconds(1);
+  // how often the page cleaner looks at the buffer pool when not woken up
+  std::chrono::milliseconds CLEANER_INTERVAL =
+   std::chrono::milliseconds(10);
+  int PAGE_SIZE = DEFAULT_PAGE_SIZE;
 }
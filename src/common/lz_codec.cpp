@@ -0,0 +1,178 @@
+/**
+ * lz_codec.cpp
+ */
+#include <cstdint>
+#include <cstring>
+
+#include "common/lz_codec.h"
+
+namespace cmudb {
+
+#define MIN_MATCH 4      // shorter matches are not worth a sequence
+#define LAST_LITERALS 5  // the input always ends with that many literals
+#define MAX_OFFSET 65535 // offsets are 2 bytes
+#define HASH_BITS 12
+
+static inline uint32_t Read32(const uint8_t *p) {
+  uint32_t value;
+  memcpy(&value, p, 4);
+  return value;
+}
+
+static inline uint32_t Hash(uint32_t sequence) {
+  return (sequence * 2654435761U) >> (32 - HASH_BITS);
+}
+
+// the part of a length that did not fit into its nibble
+static bool WriteLength(uint8_t *&op, const uint8_t *op_end, int length) {
+  for (; length >= 255; length -= 255) {
+    if (op == op_end) {
+      return false;
+    }
+    *op++ = 255;
+  }
+  if (op == op_end) {
+    return false;
+  }
+  *op++ = length;
+  return true;
+}
+
+static bool ReadLength(const uint8_t *&ip, const uint8_t *ip_end,
+                       int &length) {
+  uint8_t byte;
+  do {
+    if (ip == ip_end) {
+      return false;
+    }
+    byte = *ip++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/*
+ * Emit literals followed by a match of match_length bytes at offset, or by
+ * nothing for the last sequence (match_length 0)
+ */
+static bool WriteSequence(uint8_t *&op, const uint8_t *op_end,
+                          const uint8_t *literals, int literal_length,
+                          int offset, int match_length) {
+  if (op == op_end) {
+    return false;
+  }
+  uint8_t *token = op++;
+  *token = (literal_length < 15 ? literal_length : 15) << 4;
+  if (literal_length >= 15 && !WriteLength(op, op_end, literal_length - 15)) {
+    return false;
+  }
+  if (op_end - op < literal_length) {
+    return false;
+  }
+  memcpy(op, literals, literal_length);
+  op += literal_length;
+  if (match_length == 0) {
+    return true;
+  }
+  if (op_end - op < 2) {
+    return false;
+  }
+  *op++ = offset & 0xff;
+  *op++ = offset >> 8;
+  match_length -= MIN_MATCH;
+  *token |= match_length < 15 ? match_length : 15;
+  return match_length < 15 || WriteLength(op, op_end, match_length - 15);
+}
+
+int LZCodec::Compress(const char *src, int src_size, char *dst,
+                      int dst_capacity) {
+  const uint8_t *base = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *ip = base;
+  const uint8_t *anchor = base; // start of the pending literals
+  uint8_t *op = reinterpret_cast<uint8_t *>(dst);
+  const uint8_t *op_end = op + dst_capacity;
+
+  if (src_size >= MIN_MATCH + LAST_LITERALS) {
+    const uint8_t *match_limit = base + src_size - LAST_LITERALS;
+    // position + 1 of the last occurrence of a hash, 0 for none
+    int table[1 << HASH_BITS];
+    memset(table, 0, sizeof(table));
+    while (ip + MIN_MATCH <= match_limit) {
+      uint32_t sequence = Read32(ip);
+      int &slot = table[Hash(sequence)];
+      const uint8_t *match = slot == 0 ? nullptr : base + slot - 1;
+      bool found = match != nullptr && ip - match <= MAX_OFFSET &&
+                   Read32(match) == sequence;
+      slot = ip - base + 1;
+      if (!found) {
+        ip++;
+        continue;
+      }
+      int offset = ip - match;
+      const uint8_t *match_end = ip + MIN_MATCH;
+      match += MIN_MATCH;
+      while (match_end < match_limit && *match_end == *match) {
+        match_end++;
+        match++;
+      }
+      if (!WriteSequence(op, op_end, anchor, ip - anchor, offset,
+                         match_end - ip)) {
+        return 0;
+      }
+      ip = match_end;
+      anchor = ip;
+    }
+  }
+  if (!WriteSequence(op, op_end, anchor, base + src_size - anchor, 0, 0)) {
+    return 0;
+  }
+  return op - reinterpret_cast<uint8_t *>(dst);
+}
+
+int LZCodec::Decompress(const char *src, int src_size, char *dst,
+                        int dst_capacity) {
+  const uint8_t *ip = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *ip_end = ip + src_size;
+  uint8_t *base = reinterpret_cast<uint8_t *>(dst);
+  uint8_t *op = base;
+  const uint8_t *op_end = base + dst_capacity;
+
+  while (ip < ip_end) {
+    uint8_t token = *ip++;
+    int literal_length = token >> 4;
+    if (literal_length == 15 && !ReadLength(ip, ip_end, literal_length)) {
+      return -1;
+    }
+    if (ip_end - ip < literal_length || op_end - op < literal_length) {
+      return -1;
+    }
+    memcpy(op, ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+    if (ip == ip_end) {
+      break; // the last sequence
+    }
+
+    if (ip_end - ip < 2) {
+      return -1;
+    }
+    int offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    int match_length = token & 15;
+    if (match_length == 15 && !ReadLength(ip, ip_end, match_length)) {
+      return -1;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > op - base || op_end - op < match_length) {
+      return -1;
+    }
+    // byte by byte: a match may overlap its own output
+    const uint8_t *match = op - offset;
+    for (int i = 0; i < match_length; ++i) {
+      *op++ = *match++;
+    }
+  }
+  return op - base;
+}
+
+} // namespace cmudb
@@ -0,0 +1,62 @@
+/**
+ * cache_disk_manager.cpp
+ */
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include "common/logger.h"
+#include "disk/cache_disk_manager.h"
+
+namespace cmudb {
+
+CacheDiskManager::CacheDiskManager(const std::string &file_name,
+                                   size_t num_slots)
+    : file_name_(file_name), num_slots_(num_slots), num_reads_(0),
+      num_writes_(0) {
+  cache_io_.open(file_name_, std::ios::binary | std::ios::trunc |
+                                 std::ios::in | std::ios::out);
+  if (!cache_io_.is_open()) {
+    LOG_DEBUG("cannot create victim cache file");
+  }
+}
+
+CacheDiskManager::~CacheDiskManager() {
+  if (cache_io_.is_open()) {
+    cache_io_.close();
+    remove(file_name_.c_str());
+  }
+}
+
+void CacheDiskManager::WriteSlot(size_t slot, const char *page_data) {
+  assert(slot < num_slots_);
+  num_writes_++;
+  std::lock_guard<std::mutex> lock(cache_io_latch_);
+  cache_io_.seekp(static_cast<long>(slot) * PAGE_SIZE);
+  cache_io_.write(page_data, PAGE_SIZE);
+  // check for I/O error
+  if (cache_io_.bad()) {
+    LOG_DEBUG("I/O error while writing");
+  }
+  // no flush: a lost slot is only a cache miss
+}
+
+void CacheDiskManager::ReadSlot(size_t slot, char *page_data) {
+  assert(slot < num_slots_);
+  num_reads_++;
+  std::lock_guard<std::mutex> lock(cache_io_latch_);
+  cache_io_.seekp(static_cast<long>(slot) * PAGE_SIZE);
+  cache_io_.read(page_data, PAGE_SIZE);
+  int read_count = cache_io_.gcount();
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    cache_io_.clear();
+  }
+}
+
+int CacheDiskManager::GetNumReads() const { return num_reads_; }
+
+int CacheDiskManager::GetNumWrites() const { return num_writes_; }
+
+} // namespace cmudb
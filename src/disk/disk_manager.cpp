@@ -1,29 +1,47 @@
 /**
  * disk_manager.cpp
  */
+#include <algorithm>
 #include <assert.h>
 #include <cstring>
 #include <iostream>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <thread>
+#include <unistd.h>
 
+#include "common/exception.h"
 #include "common/logger.h"
 #include "disk/disk_manager.h"
 
 namespace cmudb {
 
-static char *buffer_used = nullptr;
+std::mutex DiskManager::open_latch_;
+int DiskManager::num_open_ = 0;
 
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
+ * @input page_size: page size of a new database file, a power of two from
+ * MIN_PAGE_SIZE to MAX_PAGE_SIZE. A file that has a header page keeps the
+ * page size recorded there. Either way PAGE_SIZE is set to it, which throws
+ * if another open DiskManager uses a different one. So does a file whose
+ * header page is of another format version
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), flush_log_(false),
-      flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, int page_size)
+    : db_fd_(-1), file_name_(db_file), next_page_id_(0), num_flushes_(0),
+      num_reads_(0), num_read_requests_(0), num_write_requests_(0),
+      flush_log_(false), flush_log_f_(nullptr), buffer_used_(nullptr) {
+  if (!IsValidPageSize(page_size)) {
+    throw Exception(EXCEPTION_TYPE_OUT_OF_RANGE, "invalid page size");
+  }
+  for (auto &version : page_versions_) {
+    version = 0;
+  }
   std::string::size_type n = file_name_.find(".");
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
+    UsePageSize(page_size);
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
@@ -53,9 +71,64 @@ DiskManager::DiskManager(const std::string &db_file)
     // reopen with original mode
     db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
   }
+  db_fd_ = open(db_file.c_str(), O_RDWR);
+
+  // an existing database file decides its page size itself. Without the
+  // magic page 0 is no header page of this format, or none was written yet
+  int header[HEADER_PAGE_RECORDS_OFFSET / 4] = {0};
+  if (GetFileSize(file_name_) >= HEADER_PAGE_RECORDS_OFFSET) {
+    db_io_.seekp(0);
+    db_io_.read(reinterpret_cast<char *>(header), sizeof(header));
+    db_io_.clear();
+  }
+  int recorded_page_size = header[HEADER_PAGE_SIZE_OFFSET / 4];
+  if (header[HEADER_PAGE_MAGIC_OFFSET / 4] == HEADER_PAGE_MAGIC) {
+    if (header[HEADER_PAGE_VERSION_OFFSET / 4] != HEADER_PAGE_VERSION ||
+        !IsValidPageSize(recorded_page_size)) {
+      close(db_fd_);
+      throw Exception(EXCEPTION_TYPE_SERIALIZATION,
+                      "header page of " + db_file + " is of another format");
+    }
+    page_size = recorded_page_size;
+  }
+  try {
+    UsePageSize(page_size);
+  } catch (...) {
+    close(db_fd_);
+    throw;
+  }
+}
+
+/**
+ * PAGE_SIZE is one per process: only the first of the open DiskManagers
+ * sets it, the others must agree
+ */
+void DiskManager::UsePageSize(int page_size) {
+  std::lock_guard<std::mutex> lock(open_latch_);
+  if (num_open_ > 0 && page_size != PAGE_SIZE) {
+    throw Exception(EXCEPTION_TYPE_MISMATCH_TYPE,
+                    "page size differs from the one of the open database");
+  }
+  PAGE_SIZE = page_size;
+  num_open_++;
+}
+
+/**
+ * Page sizes are powers of two from MIN_PAGE_SIZE to MAX_PAGE_SIZE
+ */
+bool DiskManager::IsValidPageSize(int page_size) {
+  return page_size >= MIN_PAGE_SIZE && page_size <= MAX_PAGE_SIZE &&
+         (page_size & (page_size - 1)) == 0;
 }
 
 DiskManager::~DiskManager() {
+  {
+    std::lock_guard<std::mutex> lock(open_latch_);
+    num_open_--;
+  }
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
   db_io_.close();
   log_io_.close();
 }
@@ -64,29 +137,35 @@ DiskManager::~DiskManager() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = page_id * PAGE_SIZE;
+  num_write_requests_++;
+  long offset = static_cast<long>(page_id) * PAGE_SIZE;
+  std::lock_guard<std::mutex> lock(db_io_latch_);
+  BumpPageVersions(page_id, 1);
   // set write cursor to offset
   db_io_.seekp(offset);
   db_io_.write(page_data, PAGE_SIZE);
   // check for I/O error
   if (db_io_.bad()) {
     LOG_DEBUG("I/O error while writing");
-    return;
   }
   // needs to flush to keep disk file in sync
   db_io_.flush();
+  BumpPageVersions(page_id, 1);
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
+  num_reads_++;
+  num_read_requests_++;
+  long offset = static_cast<long>(page_id) * PAGE_SIZE;
   // check if read beyond file length
   if (offset > GetFileSize(file_name_)) {
     LOG_DEBUG("I/O error while reading");
     // std::cerr << "I/O error while reading" << std::endl;
   } else {
+    std::lock_guard<std::mutex> lock(db_io_latch_);
     // set read cursor to offset
     db_io_.seekp(offset);
     db_io_.read(page_data, PAGE_SIZE);
@@ -96,10 +175,139 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
       LOG_DEBUG("Read less than a page");
       // std::cerr << "Read less than a page" << std::endl;
       memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+      // a short read sets eof/fail, which would make every later write fail
+      db_io_.clear();
     }
   }
 }
 
+/**
+ * Read a run of consecutive pages with a single seek: the pages are
+ * contiguous in the file, so after the first one the read cursor is already
+ * where the next one starts. Pages past the end of the file read as zeros
+ */
+void DiskManager::ReadPages(page_id_t first_page_id, size_t num_pages,
+                            char *const *page_data) {
+  num_reads_ += num_pages;
+  num_read_requests_++;
+  long offset = static_cast<long>(first_page_id) * PAGE_SIZE;
+  long file_size = GetFileSize(file_name_);
+  std::lock_guard<std::mutex> lock(db_io_latch_);
+  bool at_end = offset > file_size;
+  if (at_end) {
+    LOG_DEBUG("I/O error while reading");
+  } else {
+    // set read cursor to offset
+    db_io_.seekp(offset);
+  }
+  for (size_t i = 0; i < num_pages; ++i) {
+    int read_count = 0;
+    if (!at_end) {
+      db_io_.read(page_data[i], PAGE_SIZE);
+      read_count = db_io_.gcount();
+    }
+    if (read_count < PAGE_SIZE) {
+      memset(page_data[i] + read_count, 0, PAGE_SIZE - read_count);
+      if (!at_end) {
+        // a short read sets eof/fail, which would make every later write
+        // fail
+        db_io_.clear();
+        at_end = true;
+      }
+    }
+  }
+}
+
+/**
+ * Write a run of consecutive pages with a single seek and no flush in
+ * between, the caller batches up runs and calls Sync() once after the last
+ * if they must be durable.
+ * The stream is flushed at the end of the run all the same: the run has to
+ * be in the file before its page versions are even again, or a mapping of
+ * the file could see it half written
+ */
+void DiskManager::WritePages(page_id_t first_page_id, size_t num_pages,
+                             const char *const *page_data) {
+  num_write_requests_++;
+  long offset = static_cast<long>(first_page_id) * PAGE_SIZE;
+  std::lock_guard<std::mutex> lock(db_io_latch_);
+  BumpPageVersions(first_page_id, num_pages);
+  // set write cursor to offset
+  db_io_.seekp(offset);
+  for (size_t i = 0; i < num_pages; ++i) {
+    db_io_.write(page_data[i], PAGE_SIZE);
+  }
+  // check for I/O error
+  if (db_io_.bad()) {
+    LOG_DEBUG("I/O error while writing");
+  }
+  db_io_.flush();
+  BumpPageVersions(first_page_id, num_pages);
+}
+
+/**
+ * Hand the page writes still buffered in the db file stream to the file,
+ * then wait until the file data is on the device. The wait needs no
+ * db_io_latch_, page I/O of other threads goes on meanwhile
+ */
+void DiskManager::Sync() {
+  {
+    std::lock_guard<std::mutex> lock(db_io_latch_);
+    db_io_.flush();
+  }
+  if (db_fd_ < 0 || fdatasync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+}
+
+/**
+ * Map the database file for a scan. Page writes still buffered in the
+ * stream are handed to the file first, so that the mapping shows them
+ */
+std::shared_ptr<MappedFile> DiskManager::MapFile() {
+  {
+    std::lock_guard<std::mutex> lock(db_io_latch_);
+    db_io_.flush();
+  }
+  auto mapped_file = std::make_shared<MappedFile>(file_name_, this);
+  if (!mapped_file->IsMapped()) {
+    return nullptr;
+  }
+  return mapped_file;
+}
+
+/*
+ * Called with db_io_latch_ before and after writing a run of pages, the
+ * writers are serialized by it. A run of consecutive pages has consecutive
+ * stripes, each one is bumped once, so they are all odd in between
+ */
+void DiskManager::BumpPageVersions(page_id_t first_page_id,
+                                   size_t num_pages) {
+  size_t num_stripes =
+      std::min<size_t>(num_pages, DISK_WRITE_VERSION_STRIPES);
+  for (size_t i = 0; i < num_stripes; ++i) {
+    page_versions_[(first_page_id + i) % DISK_WRITE_VERSION_STRIPES]
+        .fetch_add(1, std::memory_order_acq_rel);
+  }
+}
+
+uint64_t DiskManager::ReadPageVersion(page_id_t page_id) const {
+  return page_versions_[page_id % DISK_WRITE_VERSION_STRIPES].load(
+      std::memory_order_acquire);
+}
+
+/*
+ * Whether nothing wrote page_id since version was read, and nothing was
+ * writing it then
+ */
+bool DiskManager::ValidatePageVersion(page_id_t page_id,
+                                      uint64_t version) const {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return (version & 1) == 0 &&
+         page_versions_[page_id % DISK_WRITE_VERSION_STRIPES].load(
+             std::memory_order_relaxed) == version;
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
@@ -107,8 +315,8 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
 void DiskManager::WriteLog(char *log_data, int size) {
   // enforce swap log buffer
   LOG_DEBUG("DiskManager::WriteLog size %d", size);
-  assert(log_data != buffer_used);
-  buffer_used = log_data;
+  assert(log_data != buffer_used_);
+  buffer_used_ = log_data;
 
   if (size == 0) // no effect on num_flushes_ if log buffer is empty
     return;
@@ -165,10 +373,12 @@ page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
+ * Need bitmap in header page for tracking pages. Until then only the page
+ * allocated last can be given back, e.g. by a NewPage that found no frame
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-  return;
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  page_id_t next_page_id = page_id + 1;
+  next_page_id_.compare_exchange_strong(next_page_id, page_id);
 }
 
 /**
@@ -176,6 +386,23 @@ void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {
  */
 int DiskManager::GetNumFlushes() const { return num_flushes_; }
 
+/**
+ * Returns number of page reads made so far
+ */
+int DiskManager::GetNumReads() const { return num_reads_; }
+
+/**
+ * Returns number of read requests made so far, a run read by ReadPages is
+ * a single request
+ */
+int DiskManager::GetNumReadRequests() const { return num_read_requests_; }
+
+/**
+ * Returns number of page write requests made so far, a run written by
+ * WritePages is a single request
+ */
+int DiskManager::GetNumWriteRequests() const { return num_write_requests_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
@@ -184,7 +411,7 @@ bool DiskManager::GetFlushState() const { return flush_log_; }
 /**
  * Private helper function to get disk file size
  */
-int DiskManager::GetFileSize(const std::string &file_name) {
+long DiskManager::GetFileSize(const std::string &file_name) {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
   return rc == 0 ? stat_buf.st_size : -1;
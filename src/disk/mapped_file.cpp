@@ -0,0 +1,67 @@
+/**
+ * mapped_file.cpp
+ */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/logger.h"
+#include "disk/disk_manager.h"
+#include "disk/mapped_file.h"
+
+namespace cmudb {
+
+MappedFile::MappedFile(const std::string &file_name, DiskManager *disk_manager)
+    : disk_manager_(disk_manager), data_(nullptr), mapped_size_(0),
+      num_pages_(0) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG_DEBUG("cannot open database file for mapping");
+    return;
+  }
+  struct stat stat_buf;
+  // a partly written last page is left to the buffer pool
+  if (fstat(fd, &stat_buf) == 0 && stat_buf.st_size >= PAGE_SIZE) {
+    num_pages_ = stat_buf.st_size / PAGE_SIZE;
+    mapped_size_ = static_cast<size_t>(num_pages_) * PAGE_SIZE;
+    void *memory =
+        mmap(nullptr, mapped_size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (memory != MAP_FAILED) {
+      data_ = static_cast<char *>(memory);
+      // read ahead aggressively, free pages soon after they were read
+      madvise(data_, mapped_size_, MADV_SEQUENTIAL);
+    } else {
+      LOG_DEBUG("cannot map database file");
+      num_pages_ = 0;
+      mapped_size_ = 0;
+    }
+  }
+  // the mapping stays valid without the descriptor
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(data_, mapped_size_);
+  }
+}
+
+bool MappedFile::View(page_id_t page_id, Page &view) const {
+  if (page_id < 0 || page_id >= num_pages_) {
+    return false;
+  }
+  view.data_ = data_ + static_cast<size_t>(page_id) * PAGE_SIZE;
+  view.page_id_ = page_id;
+  return true;
+}
+
+uint64_t MappedFile::ReadVersion(page_id_t page_id) const {
+  return disk_manager_->ReadPageVersion(page_id);
+}
+
+bool MappedFile::ValidateVersion(page_id_t page_id, uint64_t version) const {
+  return disk_manager_->ValidatePageVersion(page_id, version);
+}
+
+} // namespace cmudb
@@ -1,42 +1,88 @@
+#include <cassert>
+#include <cstring>
 #include <list>
+#include <new>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "hash/extendible_hash.h"
 #include "page/page.h"
-#include <bitset>
-#include <assert.h>
-#include "common/logger.h"
 
 namespace cmudb {
 
-// we use least significant bits in this impl
-// to get the right-most N bits
-// int n = original_value & ((1 << N) - 1);
+// fingerprints compared at once, and the bit mask of the slots among them
+// whose fingerprint is the one probed for
+#if defined(__AVX2__)
+static const size_t PROBE_GROUP = 32;
+static inline uint32_t MatchGroup(const uint8_t *group, uint8_t fingerprint) {
+  __m256i fingerprints =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(group));
+  return _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+      fingerprints, _mm256_set1_epi8(static_cast<char>(fingerprint))));
+}
+#elif defined(__SSE2__)
+static const size_t PROBE_GROUP = 16;
+static inline uint32_t MatchGroup(const uint8_t *group, uint8_t fingerprint) {
+  __m128i fingerprints =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(
+      fingerprints, _mm_set1_epi8(static_cast<char>(fingerprint))));
+}
+#else
+static const size_t PROBE_GROUP = 8;
+static inline uint32_t MatchGroup(const uint8_t *group, uint8_t fingerprint) {
+  uint32_t matches = 0;
+  for (size_t i = 0; i < PROBE_GROUP; ++i) {
+    matches |= static_cast<uint32_t>(group[i] == fingerprint) << i;
+  }
+  return matches;
+}
+#endif
+
+// the directory is indexed by the global_depth_ least significant bits of a
+// hash, a bucket of local depth d is shared by all slots that agree with its
+// first slot in their d least significant bits. A bucket latch is only ever
+// taken with the directory read latch held
 
 /*
  * constructor
- * array_size: fixed array size for each bucket
+ * size: fixed array size for each bucket
  */
 template <typename K, typename V>
-ExtendibleHash<K, V>::ExtendibleHash(size_t size) 
-: mDepth(1), mBucketDataSize(size) {
-  mDirectory.emplace_back(new Bucket(mDepth, 0));
-  mDirectory.emplace_back(new Bucket(mDepth, 1));
-  mBucketCount = 2;
+ExtendibleHash<K, V>::ExtendibleHash(size_t size)
+    : bucket_size_(size), global_depth_(0), directory_(1) {
+  directory_[0].store(NewBucket(0));
+}
+
+template <typename K, typename V> ExtendibleHash<K, V>::~ExtendibleHash() {
+  for (auto bucket : buckets_) {
+    FreeBucket(bucket);
+  }
+}
+
+static inline size_t RoundUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
 }
 
 /*
- * helper function to calculate the hashing address of input key
+ * helper function to calculate the hashing address of input key. The
+ * finalizer of MurmurHash3 mixes std::hash, which is the identity for
+ * integers and pointers: consecutive ids or aligned addresses would fill the
+ * directory unevenly and share fingerprints
  */
 template <typename K, typename V>
 size_t ExtendibleHash<K, V>::HashKey(const K &key) {
   std::hash<K> key_hash;
-  return key_hash(key);
-}
-
-template <typename K, typename V>
-size_t ExtendibleHash<K, V>::GetBucketIndexFromHash(size_t hash) {
-  int n = hash & ((1 << mDepth) - 1);
-  return n;
+  uint64_t hash = key_hash(key);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
 }
 
 /*
@@ -45,49 +91,50 @@ size_t ExtendibleHash<K, V>::GetBucketIndexFromHash(size_t hash) {
  */
 template <typename K, typename V>
 int ExtendibleHash<K, V>::GetGlobalDepth() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return mDepth;
+  directory_latch_.RLock();
+  int global_depth = global_depth_;
+  directory_latch_.RUnlock();
+  return global_depth;
 }
 
 /*
- * helper function to return local depth of one specific bucket
+ * helper function to return local depth of the bucket in directory slot
+ * bucket_id, -1 if there is no such slot or its bucket is empty
  * NOTE: you must implement this function in order to pass test
  */
 template <typename K, typename V>
 int ExtendibleHash<K, V>::GetLocalDepth(int bucket_id) const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  if (size_t(bucket_id) >= GetDirCapacity()) {
-    return -1;
-  }
-
-  if (mDirectory[bucket_id] != nullptr) {
-    size_t numOfItems = mDirectory[bucket_id]->dataMap.size();
-    //LOG_INFO("num of items in bucket index %d is: %lu", bucket_id, numOfItems);
-    if (numOfItems == 0)
-      return -1; // for pass the test
-    return mDirectory[bucket_id]->mLocalDepth;
+  int local_depth = -1;
+  directory_latch_.RLock();
+  if (bucket_id >= 0 && static_cast<size_t>(bucket_id) < directory_.size()) {
+    Bucket *bucket = directory_[bucket_id].load(std::memory_order_acquire);
+    bucket->latch_.RLock();
+    if (bucket->size_ != 0) {
+      local_depth = bucket->local_depth_;
+    }
+    bucket->latch_.RUnlock();
   }
-  return -1;
+  directory_latch_.RUnlock();
+  return local_depth;
 }
 
 /*
- * helper function to return current number of bucket in hash table
+ * helper function to return current number of non-empty buckets in hash
+ * table. With the directory write latch nobody holds a bucket latch
  */
 template <typename K, typename V>
 int ExtendibleHash<K, V>::GetNumBuckets() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-
+  directory_latch_.WLock();
   int count = 0;
-  int i = 0;
-  for (auto b:mDirectory) {
-    size_t numOfItems = b->dataMap.size();
-    // if actually owns the bucket (id matches its index), and contains at lease one item, count
-    if (numOfItems > 0 && b->mId == i) {
+  for (size_t i = 0; i < directory_.size(); ++i) {
+    Bucket *bucket = directory_[i].load(std::memory_order_relaxed);
+    // count a bucket at its first slot only
+    if (bucket->size_ != 0 &&
+        i < (static_cast<size_t>(1) << bucket->local_depth_)) {
       count++;
     }
-    i++;
   }
-
+  directory_latch_.WUnlock();
   return count;
 }
 
@@ -96,20 +143,16 @@ int ExtendibleHash<K, V>::GetNumBuckets() const {
  */
 template <typename K, typename V>
 bool ExtendibleHash<K, V>::Find(const K &key, V &value) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  size_t index = GetBucketIndexFromHash(HashKey(key));
-  if (index >= GetDirCapacity()) {
-    //LOG_INFO("index %lu beyond limit", index);
-    return false;
-  }
-
-  //LOG_INFO("index %lu is finding", index);
-  auto search = mDirectory[index]->dataMap.find(key);
-  if (search != mDirectory[index]->dataMap.end()) {
-    value = search->second;
-    return true;
+  size_t hash = HashKey(key);
+  directory_latch_.RLock();
+  Bucket *bucket = LatchBucket(IndexOf(hash), false);
+  int slot = FindSlot(bucket, key, FingerprintOf(hash));
+  if (slot >= 0) {
+    value = bucket->values_[slot];
   }
-  return false;
+  bucket->latch_.RUnlock();
+  directory_latch_.RUnlock();
+  return slot >= 0;
 }
 
 /*
@@ -118,115 +161,231 @@ bool ExtendibleHash<K, V>::Find(const K &key, V &value) {
  */
 template <typename K, typename V>
 bool ExtendibleHash<K, V>::Remove(const K &key) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  size_t index = GetBucketIndexFromHash(HashKey(key));
-  if (index >= GetDirCapacity()) {
-    return false;
-  }
-  auto search = mDirectory[index]->dataMap.find(key);
-  if (search != mDirectory[index]->dataMap.end()) {
-    mDirectory[index]->dataMap.erase(key);
-    return true;
+  size_t hash = HashKey(key);
+  directory_latch_.RLock();
+  Bucket *bucket = LatchBucket(IndexOf(hash), true);
+  int slot = FindSlot(bucket, key, FingerprintOf(hash));
+  if (slot >= 0) {
+    // the last entry fills the hole
+    size_t last = --bucket->size_;
+    if (static_cast<size_t>(slot) != last) {
+      bucket->fingerprints_[slot] = bucket->fingerprints_[last];
+      bucket->keys_[slot] = std::move(bucket->keys_[last]);
+      bucket->values_[slot] = std::move(bucket->values_[last]);
+    }
+    ClearSlot(bucket, last);
   }
-  return false;
+  bucket->latch_.WUnlock();
+  directory_latch_.RUnlock();
+  return slot >= 0;
 }
 
+/*
+ * insert <key,value> entry in hash table
+ * Split & Redistribute bucket when there is overflow and if necessary increase
+ * global depth
+ */
 template <typename K, typename V>
-void ExtendibleHash<K, V>::Split(size_t index, const K &key, const V &value) {
-  auto bucket = mDirectory[index];
-  if (bucket->mLocalDepth == mDepth)
-  {
-    //LOG_INFO("too bad, bucket index:%d is full. Need to resize directory and split buckets", bucket->mId);
-    // resize directory vector
-    size_t preSize = GetDirCapacity();
-    mDirectory.resize(preSize * 2);
-    mDepth++;
-
-    // fix new elements pointer
-    for (size_t i=preSize; i<mDirectory.capacity(); ++i) {
-      mDirectory[i] = mDirectory[i-preSize];
+void ExtendibleHash<K, V>::Insert(const K &key, const V &value) {
+  size_t hash = HashKey(key);
+  uint8_t fingerprint = FingerprintOf(hash);
+  while (true) {
+    directory_latch_.RLock();
+    size_t index = IndexOf(hash);
+    Bucket *bucket = LatchBucket(index, true);
+    int slot = FindSlot(bucket, key, fingerprint);
+    if (slot < 0 && bucket->size_ < bucket_size_) {
+      slot = bucket->size_++;
+      bucket->fingerprints_[slot] = fingerprint;
+      bucket->keys_[slot] = key;
+    }
+    if (slot >= 0) {
+      bucket->values_[slot] = value;
+      bucket->latch_.WUnlock();
+      directory_latch_.RUnlock();
+      return;
+    }
+    // full: split, growing the directory first if the bucket has a slot of
+    // its own already
+    int global_depth = global_depth_;
+    bool grow = bucket->local_depth_ == global_depth;
+    if (!grow) {
+      Split(bucket, index);
     }
-  } else {
-    //LOG_INFO("Bucket index:%d is full. Need to split buckets only", bucket->mId);
-  }
-
-  // add a new bucket
-  bucket->mLocalDepth++;
-  int newBucketId = bucket->mId+(GetDirCapacity()/2); // hack
-  int splitBucketId = bucket->mId;
-  //LOG_DEBUG("Split bucket id: %d, new bucket id: %d", splitBucketId, newBucketId);
-  
-  // fix new bucket pointer
-  //LOG_INFO("sharded ptr usage count: %lu", mDirectory[newBucketId].use_count());
-  mDirectory[newBucketId] = std::make_shared<Bucket>(bucket->mLocalDepth, newBucketId);
-  mBucketCount++;
-
-  // split bucket
-  for (auto& kv : mDirectory[splitBucketId]->dataMap) {
-    size_t newHash = GetBucketIndexFromHash(HashKey(kv.first));
-    if (int(newHash) != mDirectory[splitBucketId]->mId) {
-      //LOG_INFO("for key %d, Need to move from index: %d, to bucket index: %lu", kv.first, mDirectory[splitBucketId]->mId, newHash);
-      // now we need to make a move from bucket A to bucket B
-      if (mDirectory[newHash]->mId != int(newHash)) {
-        // adjust old pointing bucket depth
-        mDirectory[newHash]->mLocalDepth++;
-        size_t cacheDepth = mDirectory[newHash]->mLocalDepth;
-        mDirectory[newHash] = std::make_shared<Bucket>(cacheDepth, newHash);
+    bucket->latch_.WUnlock();
+    directory_latch_.RUnlock();
+    if (grow) {
+      Grow(global_depth);
+    }
+  }
+}
+
+/*
+ * Slot of key in bucket, -1 if it is not there. Only the slots whose
+ * fingerprint matches have their key compared; free slots and the padding
+ * are 0 and never match
+ */
+template <typename K, typename V>
+int ExtendibleHash<K, V>::FindSlot(const Bucket *bucket, const K &key,
+                                   uint8_t fingerprint) {
+  const uint8_t *fingerprints = bucket->fingerprints_;
+  for (size_t group = 0; group < bucket->size_; group += PROBE_GROUP) {
+    uint32_t matches = MatchGroup(fingerprints + group, fingerprint);
+    while (matches != 0) {
+      size_t slot = group + __builtin_ctz(matches);
+      if (bucket->keys_[slot] == key) {
+        return static_cast<int>(slot);
       }
+      matches &= matches - 1;
+    }
+  }
+  return -1;
+}
+
+/*
+ * Free slot, which is past the entries. Key and value are reset so that
+ * whatever they own is released now
+ */
+template <typename K, typename V>
+void ExtendibleHash<K, V>::ClearSlot(Bucket *bucket, size_t slot) {
+  bucket->fingerprints_[slot] = 0;
+  bucket->keys_[slot] = K();
+  bucket->values_[slot] = V();
+}
 
-      mDirectory[newHash]->dataMap[kv.first] = kv.second;
-      mDirectory[splitBucketId]->dataMap.erase(kv.first);
-    }      
+/*
+ * Allocate a bucket as one block: the header, then the fingerprints from
+ * the next cache line on, padded to whole probe groups, then the keys and
+ * the values
+ */
+template <typename K, typename V>
+typename ExtendibleHash<K, V>::Bucket *
+ExtendibleHash<K, V>::NewBucket(int local_depth) {
+  size_t num_fingerprints = RoundUp(bucket_size_, PROBE_GROUP);
+  size_t fingerprints_offset = RoundUp(sizeof(Bucket), CACHE_LINE_SIZE);
+  size_t keys_offset =
+      RoundUp(fingerprints_offset + num_fingerprints, alignof(K));
+  size_t values_offset =
+      RoundUp(keys_offset + bucket_size_ * sizeof(K), alignof(V));
+  void *block = nullptr;
+  if (posix_memalign(&block, CACHE_LINE_SIZE,
+                     values_offset + bucket_size_ * sizeof(V)) != 0) {
+    throw std::bad_alloc();
+  }
+  char *base = static_cast<char *>(block);
+  Bucket *bucket = new (base) Bucket();
+  bucket->local_depth_ = local_depth;
+  bucket->fingerprints_ =
+      reinterpret_cast<uint8_t *>(base + fingerprints_offset);
+  bucket->keys_ = reinterpret_cast<K *>(base + keys_offset);
+  bucket->values_ = reinterpret_cast<V *>(base + values_offset);
+  memset(bucket->fingerprints_, 0, num_fingerprints);
+  for (size_t i = 0; i < bucket_size_; ++i) {
+    new (&bucket->keys_[i]) K();
+    new (&bucket->values_[i]) V();
   }
 
-  // NOTE: adjust depth again
-  mDirectory[newBucketId]->mLocalDepth = bucket->mLocalDepth;
+  std::lock_guard<std::mutex> lock(buckets_latch_);
+  buckets_.push_back(bucket);
+  return bucket;
+}
+
+template <typename K, typename V>
+void ExtendibleHash<K, V>::FreeBucket(Bucket *bucket) {
+  for (size_t i = 0; i < bucket_size_; ++i) {
+    bucket->keys_[i].~K();
+    bucket->values_[i].~V();
+  }
+  bucket->~Bucket();
+  free(bucket);
 }
 
 /*
- * insert <key,value> entry in hash table
- * Split & Redistribute bucket when there is overflow and if necessary increase
- * global depth
+ * Latch the bucket of directory slot index, shared or exclusive, and return
+ * it. Called with the directory read latch: the directory cannot grow, but
+ * a split may repoint the slot until we hold the latch of its bucket
  */
 template <typename K, typename V>
-void ExtendibleHash<K, V>::Insert(const K &key, const V &value) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  // get hash of key, find bucket index
-  size_t index = GetBucketIndexFromHash(HashKey(key));
-
-  // lookup bucket
-  assert(GetDirCapacity() - 1 >= index);
-  auto bucket = mDirectory[index];
-
-  while (bucket->dataMap.size() >= mBucketDataSize) {
-    Split(index, key, value);   
-    index = GetBucketIndexFromHash(HashKey(key));
-    bucket = mDirectory[index];
-  }
-  bucket->dataMap[key] = value;
-  //LOG_DEBUG("Inserted to map. Bucket index:%lu, Position: %lu. Depth:%d", 
-  //    index, bucket->dataMap.size()-1, bucket->mLocalDepth);
-
-  dump(key);
-}
-
-template <typename K, typename V> 
-void ExtendibleHash<K, V>::dump(const K &key) {
-  /*LOG_DEBUG("---------------------------------------------------------------");
-  LOG_DEBUG("Global depth: %d, key: %d (%#x)", mDepth, key, key);
-  int i = 0;
-  for (auto b: mDirectory) {
-    if (b != nullptr) {
-      LOG_DEBUG("bucket: %d (%d) -> %p, local depth: %d", i, b->mId, b.get(), b->mLocalDepth);
-      for (auto item: b->dataMap) {
-        LOG_DEBUG("key: %d", item.first);
-      }
-      LOG_DEBUG("\n");
+typename ExtendibleHash<K, V>::Bucket *
+ExtendibleHash<K, V>::LatchBucket(size_t index, bool exclusive) {
+  while (true) {
+    Bucket *bucket = directory_[index].load(std::memory_order_acquire);
+    if (exclusive) {
+      bucket->latch_.WLock();
+    } else {
+      bucket->latch_.RLock();
+    }
+    if (directory_[index].load(std::memory_order_acquire) == bucket) {
+      return bucket;
+    }
+    if (exclusive) {
+      bucket->latch_.WUnlock();
     } else {
-      LOG_DEBUG("bucket: %d -> nullptr ", i);
+      bucket->latch_.RUnlock();
+    }
+  }
+}
+
+/*
+ * Split a full bucket whose local depth is below the global depth, holding
+ * its write latch and the directory read latch. Every slot of the bucket
+ * gets a bucket of its own at the global depth; the bucket itself keeps its
+ * first slot. The new buckets are filled before their slots point to them,
+ * nobody else can reach them before
+ */
+template <typename K, typename V>
+void ExtendibleHash<K, V>::Split(Bucket *bucket, size_t index) {
+  int local_depth = bucket->local_depth_;
+  assert(local_depth < global_depth_);
+  size_t first_slot = index & ((static_cast<size_t>(1) << local_depth) - 1);
+  size_t fan_out = static_cast<size_t>(1) << (global_depth_ - local_depth);
+  std::vector<Bucket *> parts(fan_out);
+  parts[0] = bucket;
+  for (size_t i = 1; i < fan_out; ++i) {
+    parts[i] = NewBucket(global_depth_);
+  }
+  // the entries staying are packed to the front of the bucket
+  size_t kept = 0;
+  for (size_t i = 0; i < bucket->size_; ++i) {
+    Bucket *part = parts[IndexOf(HashKey(bucket->keys_[i])) >> local_depth];
+    size_t slot = part == bucket ? kept++ : part->size_++;
+    if (part != bucket || slot != i) {
+      part->fingerprints_[slot] = bucket->fingerprints_[i];
+      part->keys_[slot] = std::move(bucket->keys_[i]);
+      part->values_[slot] = std::move(bucket->values_[i]);
     }
-    i++;
-  }*/
+  }
+  for (size_t i = kept; i < bucket->size_; ++i) {
+    ClearSlot(bucket, i);
+  }
+  bucket->size_ = kept;
+  bucket->local_depth_ = global_depth_;
+  for (size_t i = 1; i < fan_out; ++i) {
+    directory_[first_slot + (i << local_depth)].store(
+        parts[i], std::memory_order_release);
+  }
+}
+
+/*
+ * Double the directory, unless somebody else already grew it past
+ * global_depth meanwhile. With the directory write latch nobody holds a
+ * bucket latch, so the slots can be copied as they are
+ */
+template <typename K, typename V>
+void ExtendibleHash<K, V>::Grow(int global_depth) {
+  directory_latch_.WLock();
+  if (global_depth_ == global_depth) {
+    size_t size = directory_.size();
+    std::vector<std::atomic<Bucket *>> directory(size * 2);
+    for (size_t i = 0; i < size; ++i) {
+      Bucket *bucket = directory_[i].load(std::memory_order_relaxed);
+      directory[i].store(bucket, std::memory_order_relaxed);
+      directory[i + size].store(bucket, std::memory_order_relaxed);
+    }
+    directory_.swap(directory);
+    global_depth_++;
+  }
+  directory_latch_.WUnlock();
 }
 
 template class ExtendibleHash<page_id_t, Page *>;
@@ -0,0 +1,209 @@
+/**
+ * page_table.cpp
+ */
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "hash/page_table.h"
+
+namespace cmudb {
+
+// an empty slot ends a probe, a tombstone does not. Page ids are never
+// negative, so neither can be mistaken for an entry
+static const uint64_t EMPTY_SLOT = ~0ULL;
+static const uint64_t TOMBSTONE_SLOT = ~0ULL << 32;
+
+PageTable::PageTable(size_t max_entries)
+    : size_(0), tombstones_(0), version_(0) {
+  // keep the load factor at or below one half
+  capacity_ = CACHE_LINE_SIZE / sizeof(uint64_t);
+  while (capacity_ < 2 * max_entries) {
+    capacity_ <<= 1;
+  }
+  slots_.store(AllocateSlots(capacity_));
+  mask_.store(capacity_ - 1);
+}
+
+PageTable::~PageTable() {
+  free(slots_.load());
+  for (auto slots : retired_) {
+    free(slots);
+  }
+}
+
+/*
+ * Cache-line-aligned array of capacity empty slots
+ */
+std::atomic<uint64_t> *PageTable::AllocateSlots(size_t capacity) {
+  void *memory = nullptr;
+  if (posix_memalign(&memory, CACHE_LINE_SIZE,
+                     capacity * sizeof(std::atomic<uint64_t>)) != 0) {
+    throw std::bad_alloc();
+  }
+  auto slots = static_cast<std::atomic<uint64_t> *>(memory);
+  for (size_t i = 0; i < capacity; ++i) {
+    new (&slots[i]) std::atomic<uint64_t>(EMPTY_SLOT);
+  }
+  return slots;
+}
+
+bool PageTable::Probe(page_id_t page_id, frame_id_t &frame_id) const {
+  size_t mask = mask_.load(std::memory_order_acquire);
+  std::atomic<uint64_t> *slots = slots_.load(std::memory_order_acquire);
+  size_t slot = SlotOf(page_id, mask);
+  for (size_t i = 0; i <= mask; ++i) {
+    uint64_t word = slots[slot].load(std::memory_order_acquire);
+    if (word == EMPTY_SLOT) {
+      return false;
+    }
+    if (word != TOMBSTONE_SLOT && KeyOf(word) == page_id) {
+      frame_id = FrameOf(word);
+      return true;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return false;
+}
+
+/*
+ * Lock-free lookup. A hit is always a mapping that was in the table during
+ * the call; a miss is only trusted if no rehash ran meanwhile
+ */
+bool PageTable::Find(const page_id_t &page_id, frame_id_t &frame_id) {
+  while (true) {
+    uint64_t version = version_.load(std::memory_order_acquire);
+    if (Probe(page_id, frame_id)) {
+      return true;
+    }
+    if ((version & 1) == 0 &&
+        version_.load(std::memory_order_acquire) == version) {
+      return false;
+    }
+  }
+}
+
+/*
+ * Map page_id to frame_id, replacing an existing mapping of page_id
+ */
+void PageTable::Insert(const page_id_t &page_id, const frame_id_t &frame_id) {
+  assert(page_id >= 0 && frame_id >= 0);
+  std::lock_guard<std::mutex> lock(write_latch_);
+  std::atomic<uint64_t> *slots = slots_.load(std::memory_order_relaxed);
+  size_t mask = capacity_ - 1;
+  uint64_t word = Pack(page_id, frame_id);
+  size_t slot = SlotOf(page_id, mask);
+  size_t free_slot = capacity_;
+  for (size_t i = 0; i < capacity_; ++i) {
+    uint64_t current = slots[slot].load(std::memory_order_relaxed);
+    if (current == EMPTY_SLOT) {
+      break;
+    }
+    if (current == TOMBSTONE_SLOT) {
+      if (free_slot == capacity_) {
+        free_slot = slot;
+      }
+    } else if (KeyOf(current) == page_id) {
+      slots[slot].store(word, std::memory_order_release);
+      return;
+    }
+    slot = (slot + 1) & mask;
+  }
+  if (free_slot == capacity_) {
+    // no tombstone on the way, take the empty slot that ended the probe
+    assert(slots[slot].load(std::memory_order_relaxed) == EMPTY_SLOT);
+    free_slot = slot;
+  } else {
+    tombstones_--;
+  }
+  slots[free_slot].store(word, std::memory_order_release);
+  size_++;
+  assert(2 * size_ <= capacity_);
+}
+
+bool PageTable::Remove(const page_id_t &page_id) {
+  std::lock_guard<std::mutex> lock(write_latch_);
+  std::atomic<uint64_t> *slots = slots_.load(std::memory_order_relaxed);
+  size_t mask = capacity_ - 1;
+  size_t slot = SlotOf(page_id, mask);
+  for (size_t i = 0; i < capacity_; ++i) {
+    uint64_t current = slots[slot].load(std::memory_order_relaxed);
+    if (current == EMPTY_SLOT) {
+      return false;
+    }
+    if (current != TOMBSTONE_SLOT && KeyOf(current) == page_id) {
+      slots[slot].store(TOMBSTONE_SLOT, std::memory_order_release);
+      size_--;
+      tombstones_++;
+      // tombstones make misses probe longer, clean up once they take a
+      // quarter of the table
+      if (4 * tombstones_ > capacity_) {
+        Rehash(slots, capacity_);
+      }
+      return true;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return false;
+}
+
+/*
+ * Grow the table so that max_entries mappings keep the load factor at or
+ * below one half. The live entries move to a new array inside the sequence
+ * lock; the old array is retired, not freed, a lookup may still be in it
+ */
+void PageTable::Reserve(size_t max_entries) {
+  std::lock_guard<std::mutex> lock(write_latch_);
+  size_t capacity = capacity_;
+  while (capacity < 2 * max_entries) {
+    capacity <<= 1;
+  }
+  if (capacity == capacity_) {
+    return;
+  }
+  Rehash(AllocateSlots(capacity), capacity);
+}
+
+/*
+ * Drop all tombstones by reinserting the live entries into slots, which is
+ * either the current array or a new one of the given capacity. Readers see
+ * the version go odd and retry their misses. Caller must hold write_latch_
+ */
+void PageTable::Rehash(std::atomic<uint64_t> *slots, size_t capacity) {
+  std::atomic<uint64_t> *old_slots = slots_.load(std::memory_order_relaxed);
+  std::vector<uint64_t> entries;
+  entries.reserve(size_);
+  for (size_t i = 0; i < capacity_; ++i) {
+    uint64_t current = old_slots[i].load(std::memory_order_relaxed);
+    if (current != EMPTY_SLOT && current != TOMBSTONE_SLOT) {
+      entries.push_back(current);
+    }
+  }
+
+  version_.fetch_add(1, std::memory_order_acq_rel);
+  if (slots == old_slots) {
+    for (size_t i = 0; i < capacity; ++i) {
+      slots[i].store(EMPTY_SLOT, std::memory_order_release);
+    }
+  }
+  size_t mask = capacity - 1;
+  for (auto word : entries) {
+    size_t slot = SlotOf(KeyOf(word), mask);
+    while (slots[slot].load(std::memory_order_relaxed) != EMPTY_SLOT) {
+      slot = (slot + 1) & mask;
+    }
+    slots[slot].store(word, std::memory_order_release);
+  }
+  if (slots != old_slots) {
+    // slots before mask: a reader that sees the new mask sees the new array
+    slots_.store(slots, std::memory_order_release);
+    mask_.store(mask, std::memory_order_release);
+    retired_.push_back(old_slots);
+    capacity_ = capacity;
+  }
+  tombstones_ = 0;
+  version_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+} // namespace cmudb
@@ -0,0 +1,89 @@
+/**
+ * arc_replacer.h
+ *
+ * Functionality: Adaptive Replacement Cache (Megiddo & Modha). Resident
+ * frames live on two LRU lists: T1 holds pages seen once recently, T2 pages
+ * seen at least twice. Page ids evicted from either list are remembered on
+ * the ghost lists B1 and B2. A miss that hits a ghost list shows which list
+ * was too short, and the target size p of T1 moves toward it, so the policy
+ * follows the workload from recency (scans) to frequency (point lookups)
+ * without a tuning knob.
+ *
+ * Resident entries are indexed by frame, ghosts by page id. Accesses are
+ * reported through RecordAccess; Insert/Erase only make a resident frame
+ * evictable or not, Remove takes it off T1/T2 without leaving a ghost.
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace cmudb {
+
+template <typename T> class ARCReplacer : public Replacer<T> {
+public:
+  // capacity: number of frames of the pool, also bounds the ghost lists
+  explicit ARCReplacer(size_t capacity);
+
+  ~ARCReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Erase(const T &value);
+
+  void Remove(const T &value);
+
+  void Restore(const T &value);
+
+  size_t Size();
+
+  void EvictionCandidates(std::vector<T> &values, size_t n);
+
+  void RecordAccess(const T &value);
+
+  // current target size of T1, for tests
+  size_t GetTarget();
+
+private:
+  enum class ListType { NONE = 0, T1, T2 };
+
+  struct Slot {
+    T value_{};
+    page_id_t key_ = INVALID_PAGE_ID; // page currently in the frame
+    ListType list_ = ListType::NONE;
+    std::list<size_t>::iterator pos_;
+    bool evictable_ = false;
+  };
+
+  void Access(size_t slot, const T &value);
+  void Unlink(Slot &s);
+  void Remember(std::list<page_id_t> &ghost,
+                std::unordered_map<page_id_t, std::list<page_id_t>::iterator>
+                    &index,
+                page_id_t key);
+  void Forget(std::list<page_id_t> &ghost,
+              std::unordered_map<page_id_t, std::list<page_id_t>::iterator>
+                  &index,
+              page_id_t key);
+  bool Evict(std::list<size_t> &list, T &value);
+
+  size_t capacity_;
+  size_t target_; // p: desired size of T1
+  std::vector<Slot> slots_; // indexed by frame id
+  std::list<size_t> t1_, t2_; // resident frames, front is most recent
+  std::list<page_id_t> b1_, b2_; // ghost page ids, front is most recent
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> b1_index_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> b2_index_;
+  size_t size_; // number of evictable frames
+  std::mutex mutex_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,46 @@
+/**
+ * buffer_access_strategy.h
+ *
+ * Functionality: Access hints for FetchPage. A sequential scan touches every
+ * page once; with a BufferAccessStrategy it recycles a small private ring of
+ * frames instead of taking victims from the whole pool, so a large scan
+ * leaves the working set of other transactions alone (the same idea as the
+ * buffer access strategies of PostgreSQL).
+ *
+ * The ring only remembers page ids. When the scan misses, the buffer pool
+ * reuses the frame of a ring page that is still resident and unpinned; pages
+ * that were evicted or are pinned by somebody else are skipped and the
+ * frame comes from the pool as usual. A strategy belongs to a single scan;
+ * the scan and the prefetches it issues may use it at the same time.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+enum class AccessType {
+  RANDOM = 0,     // point lookups, the default
+  SEQUENTIAL_SCAN // each page is read once: does not count as a reuse
+};
+
+class BufferAccessStrategy {
+  friend class BufferPoolManager;
+
+public:
+  explicit BufferAccessStrategy(size_t ring_size = SCAN_RING_SIZE)
+      : ring_(ring_size, INVALID_PAGE_ID), hand_(0) {}
+
+  inline size_t GetRingSize() const { return ring_.size(); }
+
+private:
+  std::vector<page_id_t> ring_; // pages the scan brought in
+  size_t hand_;                 // next ring slot to recycle
+  std::mutex latch_;            // taken after the latch of a buffer pool
+};
+
+} // namespace cmudb
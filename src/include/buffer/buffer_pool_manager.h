@@ -7,41 +7,236 @@
  */
 
 #pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/buffer_pool_trace.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/compressed_tier.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_guard.h"
+#include "buffer/victim_cache.h"
 #include "disk/disk_manager.h"
-#include "hash/extendible_hash.h"
+#include "hash/page_table.h"
 #include "logging/log_manager.h"
 #include "page/page.h"
 
 namespace cmudb {
+
+// replacement policy used to pick victim frames
+enum class ReplacerType { LRU = 0, CLOCK, LRU_K, ARC };
+
 class BufferPoolManager {
+  // hands the page ids it allocated to the shard owning them
+  friend class ParallelBufferPoolManager;
+
 public:
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
-                          LogManager *log_manager = nullptr);
+                          LogManager *log_manager = nullptr,
+                          ReplacerType replacer_type = ReplacerType::LRU,
+                          size_t replacer_k = LRUK_REPLACER_K);
+
+  virtual ~BufferPoolManager();
+
+  // a scan passing SEQUENTIAL_SCAN and its strategy recycles the frames of
+  // its own ring on a miss
+  virtual Page *FetchPage(page_id_t page_id,
+                          AccessType access_type = AccessType::RANDOM,
+                          BufferAccessStrategy *strategy = nullptr);
+
+  virtual bool UnpinPage(page_id_t page_id, bool is_dirty);
+
+  // the same for a page the caller still has, without looking it up
+  virtual bool UnpinFrame(Page *page, bool is_dirty);
+
+  // FetchPage/NewPage with the page latched, latch and pin are released by
+  // the guard. The guard is empty if every frame is pinned
+  ReadPageGuard FetchPageRead(page_id_t page_id,
+                              AccessType access_type = AccessType::RANDOM,
+                              BufferAccessStrategy *strategy = nullptr);
+  WritePageGuard FetchPageWrite(page_id_t page_id);
+  WritePageGuard NewPageGuarded(page_id_t &page_id);
+
+  // pin a set of pages with one latch acquisition and sorted, coalesced
+  // reads of the misses. All or nothing: false if the pool ran out of frames
+  virtual bool FetchPages(const std::vector<page_id_t> &page_ids,
+                          std::vector<Page *> &pages,
+                          AccessType access_type = AccessType::RANDOM);
+
+  virtual bool UnpinPages(const std::vector<page_id_t> &page_ids,
+                          const std::vector<bool> &is_dirty);
+
+  virtual bool FlushPage(page_id_t page_id);
+
+  // write out every dirty page, or the dirty pages the predicate picks, in
+  // runs of consecutive page ids with a single sync at the end. Returns the
+  // number of pages written
+  size_t FlushAllPages();
+  virtual size_t
+  FlushDirtyPages(const std::function<bool(page_id_t)> &predicate);
 
-  ~BufferPoolManager();
+  virtual Page *NewPage(page_id_t &page_id);
 
-  Page *FetchPage(page_id_t page_id);
+  virtual bool DeletePage(page_id_t page_id);
 
-  bool UnpinPage(page_id_t page_id, bool is_dirty);
+  // evict the page only after all NORMAL pages, e.g. for the header page
+  // and B+ tree internal pages
+  virtual void SetPagePriority(page_id_t page_id, PagePriority priority);
 
-  bool FlushPage(page_id_t page_id);
+  // whether the pool has page_id, resident or on its way out. A scan that
+  // reads the database file directly must read such a page through the
+  // pool, the copy in the pool may be newer than the one in the file
+  virtual bool IsPageCached(page_id_t page_id);
 
-  Page *NewPage(page_id_t &page_id);
+  // read-only mapping of the database file for scans that bypass the frames
+  // (see TableHeap::MappedBegin), nullptr if the file cannot be mapped
+  virtual std::shared_ptr<MappedFile> MapDatabaseFile();
 
-  bool DeletePage(page_id_t page_id);
+  // start reading pages into the pool in the background, a hint that they
+  // will be fetched soon. A scan passes its strategy so that read-ahead
+  // recycles the frames of its ring too
+  virtual void
+  PrefetchPage(page_id_t page_id,
+               std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
+  virtual void
+  PrefetchPages(const std::vector<page_id_t> &page_ids,
+                std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
+
+  // total number of frames managed by this pool
+  virtual size_t GetPoolSize() { return pool_size_; }
+
+  // grow or shrink the pool to new_size frames while it stays in use.
+  // Shrinking waits for unpins while every frame left is pinned
+  virtual bool Resize(size_t new_size);
+
+  // statistics since construction or the last reset. They are collected
+  // unless disabled, which also stops the latency measurements
+  virtual BufferPoolStatsSnapshot GetStats() { return stats_.Snapshot(); }
+  virtual void ResetStats() { stats_.Reset(); }
+  virtual void SetStatsEnabled(bool enabled) { stats_.SetEnabled(enabled); }
+
+  // memory budget in bytes of the compressed tier for evicted pages, 0 (the
+  // default) turns it off
+  virtual void SetCompressedTierBudget(size_t budget);
+
+  // spill evicted pages into a cache file of num_pages slots, those the
+  // compressed tier does not keep if there is one. False if the pool already
+  // has a victim cache or the file cannot be created
+  virtual bool EnableVictimCache(const std::string &file_name,
+                                 size_t num_pages);
+
+  // record every FetchPage/NewPage/UnpinPage/DeletePage call, and those of
+  // the batch versions, into a trace file until StopTrace. False if the file
+  // cannot be created
+  bool StartTrace(const std::string &file_name) {
+    return trace_.Start(file_name);
+  }
+  void StopTrace() { trace_.Stop(); }
+
+  // spawn a page cleaner that writes dirty pages at the cold end of the
+  // replacer, up to batch_size per round, until the clean_target coldest
+  // evictable frames are clean
+  virtual void RunCleanerThread(size_t clean_target,
+                                size_t batch_size = CLEANER_BATCH_SIZE);
+  virtual void StopCleanerThread();
+
+protected:
+  // used by front ends (see ParallelBufferPoolManager) that own no frames
+  BufferPoolManager();
+
+  inline void TraceCall(TraceOp op, page_id_t page_id, bool flag = false) {
+    if (trace_.IsEnabled()) {
+      trace_.Record(op, page_id, flag);
+    }
+  }
+
+  BufferPoolTrace trace_; // off unless started
 
 private:
+  Page *PinPage(page_id_t page_id, AccessType access_type,
+                BufferAccessStrategy *strategy);
+  Page *PinResident(page_id_t page_id);
+  bool ClaimUnpinned(Page *page);
+  bool FindPage(page_id_t page_id, Page *&page);
+  bool UnpinLocked(page_id_t page_id, bool is_dirty);
+  bool UnpinLocked(Page *page, bool is_dirty);
+  Page *CreatePage(page_id_t &page_id, bool allocate);
+  void AddFrames(size_t num_frames);
+  Page *GetVictimFrame();
+  Replacer<Page *> *ReplacerOf(Page *page);
+  PagePriority PriorityOf(page_id_t page_id);
+  Page *GetRingFrame(BufferAccessStrategy *strategy);
+  void AddToRing(BufferAccessStrategy *strategy, page_id_t page_id);
+  Page *ClaimFrame(BufferAccessStrategy *strategy,
+                   std::unique_lock<std::mutex> &lock);
+  void ReleaseFrame(Page *page);
+  void DropFrame(Page *page, std::unique_lock<std::mutex> &lock);
+  void CountVictim(page_id_t old_page_id, bool write_back);
+  void LoadFrame(Page *page, page_id_t page_id, bool record_access,
+                 std::unique_lock<std::mutex> &lock);
+  page_id_t MapFrame(Page *page, page_id_t page_id, bool record_access,
+                     bool &dirty);
+  bool NeedsSpill(page_id_t old_page_id, bool dirty);
+  void SpillPage(page_id_t old_page_id, bool dirty, Page *page);
+  bool TakeSpilled(page_id_t page_id, Page *page);
+  void PrefetchLoop();
+  void CleanerLoop(size_t clean_target, size_t batch_size);
+  void CleanPages(size_t clean_target, size_t batch_size, char *buffer,
+                  std::unique_lock<std::mutex> &lock);
+  void WriteBack(page_id_t page_id, Page *page);
+  void WaitForIO(Page *page, std::unique_lock<std::mutex> &lock);
+  void FinishIO(Page *page, page_id_t old_page_id);
+
   size_t pool_size_; // number of pages in buffer pool
-  Page *pages_;      // array of pages
+  // frames indexed by frame id, nullptr where a shrink freed the frame.
+  // Written under latch_ and read by hits without it: growing publishes a
+  // new array, the old ones are kept until the pool is destroyed
+  std::atomic<std::atomic<Page *> *> frames_{nullptr};
+  size_t num_frame_ids_ = 0; // length of frames_, protected by latch_
+  std::vector<std::atomic<Page *> *> retired_frames_;
+  // memory of the frames, one arena per construction/growth, by frame id
+  std::vector<FrameArena *> arenas_;
+  // arenas a shrink emptied, their Page objects outlive hits without latch_
+  std::vector<FrameArena *> retired_arenas_;
   DiskManager *disk_manager_;
   LogManager *log_manager_;
-  HashTable<page_id_t, Page *> *page_table_; // to keep track of pages
+  PageTable *page_table_;        // page id to frame id of resident pages
   Replacer<Page *> *replacer_;   // to find an unpinned page for replacement
+  Replacer<Page *> *priority_replacer_; // same for HIGH priority pages
+  // ids of the HIGH priority pages, resident or not, protected by latch_
+  std::unordered_set<page_id_t> high_priority_pages_;
   std::list<Page *> *free_list_; // to find a free page for replacement
   std::mutex latch_;             // to protect shared data structure
+  // pages whose evicted dirty copy is being written back without latch_
+  std::unordered_set<page_id_t> write_back_;
+  std::condition_variable write_back_cv_;
+  std::thread *cleaner_thread_;           // background page cleaner
+  bool cleaner_running_;                  // protected by latch_
+  std::condition_variable cleaner_cv_;    // to wake up the page cleaner
+  std::thread *prefetch_thread_;          // started by the first prefetch
+  bool prefetch_stop_;                    // protected by latch_
+  // pages waiting to be read, with the strategy of the scan that asked
+  std::deque<std::pair<page_id_t, std::shared_ptr<BufferAccessStrategy>>>
+      prefetch_queue_;
+  std::condition_variable prefetch_cv_;   // to wake up the prefetch thread
+  std::mutex resize_latch_;               // one Resize at a time
+  bool shrinking_;                        // protected by latch_
+  std::condition_variable unpin_cv_;      // a frame became evictable
+  BufferPoolStats stats_;
+  CompressedTier compressed_tier_; // off until given a budget
+  std::atomic<VictimCache *> victim_cache_{nullptr}; // set once
 };
 } // namespace cmudb
@@ -0,0 +1,122 @@
+/**
+ * buffer_pool_stats.h
+ *
+ * Functionality: Statistics of a buffer pool: hits and misses, where victim
+ * frames come from, write-backs, page creation/deletion, pin failures,
+ * compressed tier and victim cache hits and latency histograms of FetchPage
+ * hits and misses.
+ *
+ * Updates are lock-free and per thread: every thread adds to its own
+ * cache-line-aligned stripe of relaxed atomic counters, so threads never
+ * write the same line unless there are more of them than stripes. A
+ * snapshot sums up the stripes; it is not atomic as a whole, each counter is
+ * only exact on its own.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+enum class StatsCounter {
+  HIT = 0,             // FetchPage found the page in the pool
+  MISS,                // FetchPage had to read the page
+  FREE_LIST_VICTIM,    // frame for a miss or new page came from the free list
+  REPLACER_VICTIM,     // ... or evicted a resident page (scan rings included)
+  DIRTY_WRITE_BACK,    // dirty victim written by a foreground thread
+  CLEANER_WRITE_BACK,  // dirty page written by the page cleaner
+  NEW_PAGE,            // NewPage calls
+  DELETE_PAGE,         // DeletePage calls
+  PIN_FAILURE,         // FetchPage/NewPage returned nullptr, all frames pinned
+  COMPRESSED_TIER_HIT, // miss served by the compressed tier, not the disk
+  VICTIM_CACHE_HIT,    // ... or by the victim cache
+  NUM_COUNTERS
+};
+
+enum class StatsHistogram { FETCH_HIT = 0, FETCH_MISS, NUM_HISTOGRAMS };
+
+// bucket i of a histogram counts latencies below 2^i ns (and at least
+// 2^(i-1) ns), the last bucket everything slower
+typedef std::array<uint64_t, STATS_LATENCY_BUCKETS> LatencyHistogram;
+
+struct BufferPoolStatsSnapshot {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t free_list_victims = 0;
+  uint64_t replacer_victims = 0;
+  uint64_t dirty_write_backs = 0;
+  uint64_t cleaner_write_backs = 0;
+  uint64_t new_pages = 0;
+  uint64_t delete_pages = 0;
+  uint64_t pin_failures = 0;
+  uint64_t compressed_tier_hits = 0;
+  uint64_t victim_cache_hits = 0;
+  LatencyHistogram fetch_hit_latency{};
+  LatencyHistogram fetch_miss_latency{};
+
+  // fraction of FetchPage calls that were hits, 0 without any call
+  double HitRatio() const;
+  // upper bound in ns of the p-th percentile (0 < p <= 1) of a histogram,
+  // 0 for an empty one
+  static uint64_t Percentile(const LatencyHistogram &histogram, double p);
+  // add the numbers of another pool, e.g. another shard
+  BufferPoolStatsSnapshot &operator+=(const BufferPoolStatsSnapshot &other);
+};
+
+class BufferPoolStats {
+public:
+  BufferPoolStats();
+
+  BufferPoolStats(const BufferPoolStats &) = delete;
+  BufferPoolStats &operator=(const BufferPoolStats &) = delete;
+
+  inline bool IsEnabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+  inline void SetEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  inline void Add(StatsCounter counter, uint64_t n = 1) {
+    if (IsEnabled()) {
+      GetStripe().counters_[static_cast<size_t>(counter)].fetch_add(
+          n, std::memory_order_relaxed);
+    }
+  }
+
+  // start time of a latency measurement, only read the clock when enabled
+  inline std::chrono::steady_clock::time_point StartTimer() const {
+    return IsEnabled() ? std::chrono::steady_clock::now()
+                       : std::chrono::steady_clock::time_point();
+  }
+
+  // add the time since start, from StartTimer, to a histogram
+  void RecordLatency(StatsHistogram histogram,
+                     std::chrono::steady_clock::time_point start);
+
+  BufferPoolStatsSnapshot Snapshot() const;
+
+  void Reset();
+
+private:
+  struct alignas(64) Stripe {
+    std::atomic<uint64_t>
+        counters_[static_cast<size_t>(StatsCounter::NUM_COUNTERS)];
+    std::atomic<uint64_t>
+        histograms_[static_cast<size_t>(StatsHistogram::NUM_HISTOGRAMS)]
+                   [STATS_LATENCY_BUCKETS];
+  };
+
+  Stripe &GetStripe();
+
+  std::atomic<bool> enabled_;
+  Stripe stripes_[STATS_STRIPES];
+};
+
+} // namespace cmudb
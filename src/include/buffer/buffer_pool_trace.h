@@ -0,0 +1,75 @@
+/**
+ * buffer_pool_trace.h
+ *
+ * Functionality: Trace of the calls made to a buffer pool, to replay the
+ * access pattern of a real workload offline against other pool sizes and
+ * replacement policies (see tools/buffer_pool_replay.cpp).
+ *
+ * A trace file is TRACE_MAGIC followed by fixed-size TraceRecords in the
+ * byte order of the machine that wrote it, in the order the calls were
+ * recorded. Recording appends to an in-memory buffer under a latch and
+ * writes it out whenever TRACE_BUFFER_RECORDS records are buffered.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+enum class TraceOp : uint8_t { FETCH = 0, NEW, UNPIN, DELETE };
+
+struct TraceRecord {
+  uint64_t time_ns_;  // since the trace was started
+  page_id_t page_id_; // INVALID_PAGE_ID for a failed NewPage or FetchPage
+  uint16_t thread_;   // threads are numbered in order of their first call
+  TraceOp op_;
+  uint8_t flag_;      // UNPIN: is_dirty, FETCH: sequential scan
+};
+static_assert(sizeof(TraceRecord) == 16, "trace records must stay compact");
+
+#define TRACE_MAGIC "BPTRACE1"
+#define TRACE_BUFFER_RECORDS 4096 // records buffered before a write
+
+class BufferPoolTrace {
+public:
+  BufferPoolTrace();
+  ~BufferPoolTrace();
+
+  BufferPoolTrace(const BufferPoolTrace &) = delete;
+  BufferPoolTrace &operator=(const BufferPoolTrace &) = delete;
+
+  inline bool IsEnabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  // start recording into a new file, ending the current trace if any. False
+  // if the file cannot be created
+  bool Start(const std::string &file_name);
+  // write out what is buffered and close the file
+  void Stop();
+  void Record(TraceOp op, page_id_t page_id, bool flag = false);
+
+  // read a whole trace file, false if it is not one
+  static bool Read(const std::string &file_name,
+                   std::vector<TraceRecord> &records);
+
+private:
+  void WriteBuffer();
+
+  std::mutex latch_;
+  std::atomic<bool> enabled_;
+  std::ofstream file_;
+  std::chrono::steady_clock::time_point start_;
+  std::vector<TraceRecord> buffer_;
+};
+
+} // namespace cmudb
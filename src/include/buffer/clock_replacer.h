@@ -0,0 +1,51 @@
+/**
+ * clock_replacer.h
+ *
+ * Functionality: CLOCK (second chance) approximation of LRU. Every frame owns
+ * a fixed slot in an array holding its reference bit, so Insert/Erase are an
+ * index operation instead of a list + map update, and touching a frame that
+ * is already in the replacer only sets its reference bit. Victim sweeps a
+ * clock hand over the slots, clearing reference bits until it finds an
+ * unreferenced frame.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class ClockReplacer : public Replacer<T> {
+public:
+  // num_frames: number of slots to start with, grown on demand
+  explicit ClockReplacer(size_t num_frames);
+
+  ~ClockReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+  void EvictionCandidates(std::vector<T> &values, size_t n);
+
+private:
+  struct Slot {
+    T value_{};
+    bool in_replacer_ = false; // unpinned and a candidate for eviction
+    bool referenced_ = false;  // second chance bit
+  };
+
+  std::vector<Slot> slots_; // indexed by frame id
+  size_t hand_;             // next slot the clock looks at
+  size_t size_;             // number of slots in the replacer
+  std::mutex mutex_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,70 @@
+/**
+ * compressed_tier.h
+ *
+ * Functionality: Second tier of a buffer pool that keeps pages evicted from
+ * it compressed in memory, up to a memory budget. The pool puts a page in on
+ * eviction (after writing it back if it was dirty) and takes it out again on
+ * a miss before going to disk. A page is in the pool or in the tier, never
+ * in both, so the tier never has to be told about changes to a page.
+ *
+ * Pages are compressed with LZCodec; a page that does not shrink by at least
+ * an eighth is not kept. Beyond the budget the least recently put pages are
+ * dropped, they are on disk anyway. Put hands them back to the caller, which
+ * may keep them in a slower tier.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class CompressedTier {
+public:
+  struct Entry {
+    page_id_t page_id_;
+    std::string data_; // compressed page
+  };
+
+  explicit CompressedTier(size_t budget = 0);
+
+  // a tier without budget keeps nothing
+  inline bool IsEnabled() const {
+    return budget_.load(std::memory_order_relaxed) != 0;
+  }
+
+  // memory budget in bytes, a smaller one drops pages right away
+  void SetBudget(size_t budget);
+  // keep a copy of page_id, whose PAGE_SIZE bytes are at data. False if it
+  // is not kept. The pages dropped to make room for it go into dropped
+  bool Put(page_id_t page_id, const char *data,
+           std::vector<Entry> *dropped = nullptr);
+  // move page_id out of the tier into data, false if it is not there
+  bool Take(page_id_t page_id, char *data);
+  void Erase(page_id_t page_id);
+
+  // the PAGE_SIZE bytes of a dropped page into data
+  static bool Decompress(const Entry &entry, char *data);
+
+  size_t GetMemoryUsage();
+  size_t GetNumPages();
+
+private:
+  void EraseEntry(std::list<Entry>::iterator entry);
+  void Shrink(std::vector<Entry> *dropped = nullptr);
+
+  std::mutex latch_;
+  std::atomic<size_t> budget_;
+  size_t usage_; // compressed bytes plus bookkeeping of all entries
+  std::list<Entry> entries_; // most recently put first
+  std::unordered_map<page_id_t, std::list<Entry>::iterator> index_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,73 @@
+/**
+ * frame_arena.h
+ *
+ * Functionality: Memory of a block of consecutive buffer pool frames. The
+ * page data of all the frames is a single mmap'ed region: every frame starts
+ * a multiple of PAGE_SIZE past a page-aligned base, so the data is aligned
+ * the way O_DIRECT wants it and frames never straddle a cache line they do
+ * not own. A region of at least one huge page is backed by huge pages where
+ * possible: MAP_HUGETLB when FRAME_ARENA_HUGETLB is set and the system has
+ * huge pages reserved, transparent huge pages (madvise) otherwise.
+ *
+ * The frame metadata (the Page objects: page id, pin count, dirty flag) is a
+ * separate array of one cache line per frame, so the replacer, the page
+ * cleaner and other bookkeeping scans never pull page data into the cache.
+ * The latches of the frames are a third array, they are only touched by
+ * threads that latch a page or wait for its I/O.
+ *
+ * The buffer pool gets one arena at construction and one more for every
+ * Resize that grows it. Once a shrink took away all the frames of an arena
+ * its page data is released; the Page objects stay until the pool is
+ * destroyed, since a FetchPage hit may still look at them without the pool
+ * latch.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+class FrameArena {
+public:
+  // frames first_frame_id .. first_frame_id + num_frames - 1
+  FrameArena(size_t num_frames, frame_id_t first_frame_id);
+  ~FrameArena();
+
+  FrameArena(const FrameArena &) = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  inline Page *GetFrame(frame_id_t frame_id) {
+    return &frames_[frame_id - first_frame_id_];
+  }
+  inline bool Contains(frame_id_t frame_id) const {
+    return frame_id >= first_frame_id_ &&
+           frame_id < first_frame_id_ + static_cast<frame_id_t>(num_frames_);
+  }
+  inline frame_id_t GetFirstFrameId() const { return first_frame_id_; }
+  // one past the last frame id
+  inline frame_id_t GetEndFrameId() const {
+    return first_frame_id_ + static_cast<frame_id_t>(num_frames_);
+  }
+  inline bool IsHugePageBacked() const { return huge_pages_; }
+
+  // unmap the page data, no frame of the arena may be used any more
+  void ReleaseData();
+
+  // frames of this arena the buffer pool currently uses
+  size_t live_frames_;
+
+private:
+  size_t num_frames_;
+  frame_id_t first_frame_id_;
+  char *data_;         // page data of all the frames
+  size_t mapped_size_; // num_frames_ * PAGE_SIZE rounded up to whole pages
+  bool huge_pages_;    // mapped with MAP_HUGETLB or advised for THP
+  Page *frames_;       // metadata, frames_[i] owns data_ + i * PAGE_SIZE
+  FrameLatch *latches_; // latches_[i] belongs to frames_[i]
+};
+
+} // namespace cmudb
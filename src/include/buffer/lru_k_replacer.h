@@ -0,0 +1,71 @@
+/**
+ * lru_k_replacer.h
+ *
+ * Functionality: LRU-K replacement. The replacer remembers the timestamps of
+ * the last K accesses of every frame and evicts the frame whose K-th most
+ * recent access lies furthest in the past (largest backward K-distance).
+ * Frames with fewer than K recorded accesses have an infinite distance and
+ * go first, oldest access first. A page touched once by a sequential scan
+ * therefore never pushes out a page that is referenced over and over, like
+ * the internal pages of a B+ tree.
+ *
+ * Accesses are reported through RecordAccess, which the buffer pool calls on
+ * every pin, hit or miss. Insert/Erase only make a frame evictable or not.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace cmudb {
+
+template <typename T> class LRUKReplacer : public Replacer<T> {
+public:
+  // k: number of past accesses considered, k == 1 is plain LRU
+  // num_frames: number of slots to start with, grown on demand
+  explicit LRUKReplacer(size_t k, size_t num_frames = 0);
+
+  ~LRUKReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Erase(const T &value);
+
+  void Remove(const T &value);
+
+  void Restore(const T &value);
+
+  size_t Size();
+
+  void EvictionCandidates(std::vector<T> &values, size_t n);
+
+  void RecordAccess(const T &value);
+
+private:
+  struct Slot {
+    T value_{};
+    // page the history belongs to, a frame reused for another page
+    // starts over
+    page_id_t key_ = INVALID_PAGE_ID;
+    bool in_replacer_ = false;
+    std::vector<size_t> history_; // ring buffer of the last k timestamps
+    size_t accesses_ = 0;         // total accesses recorded since reset
+  };
+
+  Slot &GetSlot(const T &value);
+  void Access(Slot &slot);
+
+  size_t k_;
+  std::vector<Slot> slots_; // indexed by frame id
+  size_t current_timestamp_;
+  size_t size_; // number of slots in the replacer
+  std::mutex mutex_;
+};
+
+} // namespace cmudb
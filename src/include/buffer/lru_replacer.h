@@ -14,6 +14,7 @@
 #include <list>
 #include <map>
 #include <mutex>
+#include <vector>
 
 namespace cmudb {
 
@@ -32,6 +33,8 @@ public:
 
   size_t Size();
 
+  void EvictionCandidates(std::vector<T> &values, size_t n);
+
 private:
   // add your member variables here
   std::list<T> itemList_; // front is most frequent useage, tail is least used
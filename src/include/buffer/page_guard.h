@@ -0,0 +1,103 @@
+/**
+ * page_guard.h
+ *
+ * Functionality: Move-only owners of a pinned and latched buffer pool page.
+ * A guard releases the latch and the pin when it is destroyed, reset or
+ * moved from, so no return path can leak either; the pin is dropped through
+ * the frame (BufferPoolManager::UnpinFrame), without a page table lookup.
+ *
+ * ReadPageGuard holds the read latch and unpins the page clean.
+ * WritePageGuard holds the write latch and unpins the page dirty once its
+ * data was handed out for writing (GetDataMut/AsMut) or MarkDirty was
+ * called.
+ *
+ * An empty guard, e.g. from a fetch that found every frame pinned, tests
+ * false and must not be dereferenced.
+ */
+
+#pragma once
+
+#include "page/page.h"
+
+namespace cmudb {
+
+class BufferPoolManager;
+class WritePageGuard;
+
+class ReadPageGuard {
+public:
+  ReadPageGuard() {}
+  // take over a page pinned and read latched by the caller
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+  ~ReadPageGuard() { Release(); }
+
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+  ReadPageGuard(ReadPageGuard &&other) noexcept;
+  ReadPageGuard &operator=(ReadPageGuard &&other) noexcept;
+
+  explicit operator bool() const { return page_ != nullptr; }
+
+  inline Page *GetPage() const { return page_; }
+  inline page_id_t GetPageId() const { return page_->GetPageId(); }
+  inline const char *GetData() const { return page_->GetData(); }
+  template <typename T> const T *As() const {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+  // unlatch and unpin now, the guard is empty afterwards
+  void Release();
+
+  // turn the read latch into the write latch without letting any writer in
+  // between, so what was read stays valid. Only possible while no other
+  // thread waits for the write latch: returns an empty guard then, and this
+  // guard keeps the read latch. On success this guard is empty
+  WritePageGuard TryUpgrade();
+
+private:
+  BufferPoolManager *bpm_ = nullptr;
+  Page *page_ = nullptr;
+};
+
+class WritePageGuard {
+public:
+  WritePageGuard() {}
+  // take over a page pinned and write latched by the caller
+  WritePageGuard(BufferPoolManager *bpm, Page *page, bool is_dirty = false)
+      : bpm_(bpm), page_(page), is_dirty_(is_dirty) {}
+  ~WritePageGuard() { Release(); }
+
+  WritePageGuard(const WritePageGuard &) = delete;
+  WritePageGuard &operator=(const WritePageGuard &) = delete;
+  WritePageGuard(WritePageGuard &&other) noexcept;
+  WritePageGuard &operator=(WritePageGuard &&other) noexcept;
+
+  explicit operator bool() const { return page_ != nullptr; }
+
+  inline Page *GetPage() const { return page_; }
+  inline page_id_t GetPageId() const { return page_->GetPageId(); }
+  inline const char *GetData() const { return page_->GetData(); }
+  template <typename T> const T *As() const {
+    return reinterpret_cast<const T *>(GetData());
+  }
+  inline char *GetDataMut() {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+  template <typename T> T *AsMut() {
+    return reinterpret_cast<T *>(GetDataMut());
+  }
+  // for changes made through GetPage(), e.g. by a TablePage
+  inline void MarkDirty() { is_dirty_ = true; }
+  inline bool IsDirty() const { return is_dirty_; }
+
+  // unlatch and unpin now, the guard is empty afterwards
+  void Release();
+
+private:
+  BufferPoolManager *bpm_ = nullptr;
+  Page *page_ = nullptr;
+  bool is_dirty_ = false;
+};
+
+} // namespace cmudb
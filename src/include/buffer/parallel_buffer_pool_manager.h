@@ -0,0 +1,107 @@
+/*
+ * parallel_buffer_pool_manager.h
+ *
+ * Functionality: A buffer pool split into N independent BufferPoolManager
+ * shards. Every shard has its own latch, page table, replacer and free list,
+ * so threads working on pages of different shards never contend. A page id
+ * always lives in shard (page_id % N). Page ids still come from the disk
+ * manager, NewPage asks the shard owning the new id for its frame and moves
+ * on to the next id when that shard is full.
+ */
+
+#pragma once
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+namespace cmudb {
+class ParallelBufferPoolManager : public BufferPoolManager {
+public:
+  // pool_size is the number of frames of every single shard
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                            DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU,
+                            size_t replacer_k = LRUK_REPLACER_K);
+
+  ~ParallelBufferPoolManager();
+
+  Page *FetchPage(page_id_t page_id,
+                  AccessType access_type = AccessType::RANDOM,
+                  BufferAccessStrategy *strategy = nullptr) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+  bool UnpinFrame(Page *page, bool is_dirty) override;
+
+  bool FetchPages(const std::vector<page_id_t> &page_ids,
+                  std::vector<Page *> &pages,
+                  AccessType access_type = AccessType::RANDOM) override;
+
+  bool UnpinPages(const std::vector<page_id_t> &page_ids,
+                  const std::vector<bool> &is_dirty) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  size_t
+  FlushDirtyPages(const std::function<bool(page_id_t)> &predicate) override;
+
+  Page *NewPage(page_id_t &page_id) override;
+
+  bool DeletePage(page_id_t page_id) override;
+
+  void SetPagePriority(page_id_t page_id, PagePriority priority) override;
+
+  bool IsPageCached(page_id_t page_id) override;
+
+  // the shards share the disk manager, any of them maps the file
+  std::shared_ptr<MappedFile> MapDatabaseFile() override;
+
+  void PrefetchPage(page_id_t page_id,
+                    std::shared_ptr<BufferAccessStrategy> strategy =
+                        nullptr) override;
+
+  void PrefetchPages(const std::vector<page_id_t> &page_ids,
+                     std::shared_ptr<BufferAccessStrategy> strategy =
+                         nullptr) override;
+
+  size_t GetPoolSize() override;
+
+  // new_size is the total over all shards, spread evenly over them
+  bool Resize(size_t new_size) override;
+
+  // statistics summed up over the shards
+  BufferPoolStatsSnapshot GetStats() override;
+  void ResetStats() override;
+  void SetStatsEnabled(bool enabled) override;
+
+  // budget is the total over all shards, spread evenly over them
+  void SetCompressedTierBudget(size_t budget) override;
+
+  // one cache file per shard, file_name with the shard number appended;
+  // num_pages is the total over all shards
+  bool EnableVictimCache(const std::string &file_name,
+                         size_t num_pages) override;
+
+  // every shard gets its own cleaner, clean_target is per shard
+  void RunCleanerThread(size_t clean_target,
+                        size_t batch_size = CLEANER_BATCH_SIZE) override;
+
+  void StopCleanerThread() override;
+
+private:
+  BufferPoolManager *GetInstance(page_id_t page_id);
+  void ParkPageId(page_id_t page_id);
+  Page *NewParkedPage(page_id_t &page_id);
+
+  DiskManager *disk_manager_; // allocates the page ids of all shards
+  std::vector<BufferPoolManager *> instances_;
+  // ids allocated for a shard that had no free frame, one list per shard
+  std::mutex parked_latch_;
+  std::vector<std::deque<page_id_t>> parked_page_ids_;
+  std::atomic<size_t> num_parked_;
+};
+} // namespace cmudb
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cstdlib>
+#include <vector>
 
 namespace cmudb {
 
@@ -17,6 +18,20 @@ public:
   virtual bool Victim(T &value) = 0;
   virtual bool Erase(const T &value) = 0;
   virtual size_t Size() = 0;
+  // value was pinned for an access. Policies that only look at the unpin
+  // order just drop it from the candidates, history based ones record it
+  virtual void RecordAccess(const T &value) { Erase(value); }
+  // value leaves the replacer for good: its page is deleted, evicted by
+  // other means or moves to another replacer. Unlike Erase this drops
+  // whatever history the policy keeps about it
+  virtual void Remove(const T &value) { Erase(value); }
+  // value, just returned by Victim, was not evicted after all: its page is
+  // still in the frame, pinned. Policies that remember evicted pages take
+  // it back as resident, as if Victim had never picked it
+  virtual void Restore(const T &) {}
+  // append up to n values in the order Victim would pick them, coldest
+  // first, without removing them. Used to clean pages ahead of eviction
+  virtual void EvictionCandidates(std::vector<T> &, size_t) {}
 };
 
 } // namespace cmudb
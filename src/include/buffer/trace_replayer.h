@@ -0,0 +1,58 @@
+/**
+ * trace_replayer.h
+ *
+ * Functionality: Replay a BufferPoolTrace against a fresh buffer pool of
+ * any size and replacement policy, to see how it would have done on the
+ * traced workload.
+ *
+ * Calls are replayed one at a time in trace order, from a single thread;
+ * their timing is not reproduced. Pages are mapped to pages of a scratch
+ * database file: those the trace creates to the ids NewPage hands out
+ * during the replay, all others to ids above those. Pages that were never
+ * written read as zeros but still count as reads. A call that fails during
+ * the replay (all frames pinned) drops the matching unpin as well.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_trace.h"
+
+namespace cmudb {
+
+struct ReplayResult {
+  BufferPoolStatsSnapshot stats_;
+  int disk_reads_ = 0;          // pages read from the database file
+  int disk_write_requests_ = 0; // WritePage/WritePages calls
+  size_t failed_calls_ = 0;     // fetches/new pages that got no frame
+  double seconds_ = 0;          // wall time of the replay
+};
+
+class TraceReplayer {
+public:
+  // db_file is created for the replay and removed afterwards
+  TraceReplayer(size_t pool_size, ReplacerType replacer_type,
+                size_t replacer_k = LRUK_REPLACER_K,
+                const std::string &db_file = "replay.db");
+
+  ReplayResult Replay(const std::vector<TraceRecord> &records);
+
+private:
+  page_id_t MapPageId(page_id_t page_id);
+
+  size_t pool_size_;
+  ReplacerType replacer_type_;
+  size_t replacer_k_;
+  std::string db_file_;
+  // traced page id to replayed page id, and how many pins the replay holds
+  // on it for the trace
+  std::unordered_map<page_id_t, page_id_t> page_ids_;
+  std::unordered_map<page_id_t, int> pins_;
+  page_id_t first_unmapped_id_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,69 @@
+/**
+ * victim_cache.h
+ *
+ * Functionality: File-backed second level of a buffer pool. Pages evicted
+ * from the pool are copied into a fixed number of slots of a cache file on a
+ * separate, presumably faster device; a miss of the pool looks there before
+ * reading the database file. Like the compressed tier it is exclusive: a
+ * page taken back into the pool leaves the cache, so the cache only ever
+ * holds clean copies of pages that are not resident. Behind a compressed
+ * tier it only gets the pages the tier does not keep or drops.
+ *
+ * The index (page id to slot) is in memory. When all slots are in use, a
+ * CLOCK over the slots picks the one to overwrite; a page put again while
+ * still cached keeps its slot and gets a second chance. Slot I/O happens
+ * outside of the latch: a slot being written or read is out of the clock
+ * and off the free list until its I/O is done, so nobody else touches it.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/clock_replacer.h"
+#include "disk/cache_disk_manager.h"
+
+namespace cmudb {
+
+class VictimCache {
+public:
+  VictimCache(const std::string &file_name, size_t num_pages);
+
+  inline bool IsOpen() const { return cache_disk_manager_.IsOpen(); }
+
+  // keep a copy of page_id, whose PAGE_SIZE bytes are at data
+  void Put(page_id_t page_id, const char *data);
+  // move page_id out of the cache into data, false if it is not there
+  bool Take(page_id_t page_id, char *data);
+  void Erase(page_id_t page_id);
+
+  size_t GetNumPages();
+  inline CacheDiskManager *GetCacheDiskManager() {
+    return &cache_disk_manager_;
+  }
+
+private:
+  enum class SlotState : uint8_t {
+    FREE,
+    WRITING,
+    DISCARDED, // still being written, but its page left the cache meanwhile
+    VALID,
+    READING
+  };
+
+  void FreeSlot(int slot);
+  void DiscardSlot(int slot);
+
+  std::mutex latch_;
+  CacheDiskManager cache_disk_manager_;
+  std::unordered_map<page_id_t, int> index_; // page id to slot
+  std::vector<page_id_t> slots_;             // slot to page id
+  std::vector<SlotState> states_;
+  std::vector<int> free_slots_;
+  ClockReplacer<int> replacer_; // slots in use
+};
+
+} // namespace cmudb
@@ -16,17 +16,44 @@ extern std::chrono::duration<long long int> LOG_TIMEOUT;
 
 extern std::atomic<bool> ENABLE_LOGGING;
 
+extern std::chrono::milliseconds CLEANER_INTERVAL;
+
+// size of a data page in byte. Chosen when a database file is created and
+// recorded in its header page, DiskManager sets it when opening the file;
+// one page size per process, DiskManager refuses a second one while the
+// first is open
+extern int PAGE_SIZE;
+
 #define INVALID_PAGE_ID -1 // representing an invalid page id
 #define INVALID_TXN_ID -1  // representing an invalid txn id
 #define INVALID_LSN -1     // representing an invalid lsn
 #define HEADER_PAGE_ID 0   // the header page id
-#define PAGE_SIZE 512     // size of a data page in byte // default to 512
+#define HEADER_PAGE_SIZE_OFFSET 8 // where the header page records PAGE_SIZE
+#define HEADER_PAGE_MAGIC_OFFSET 12   // where it marks its format
+#define HEADER_PAGE_VERSION_OFFSET 16 // and the version of it
+#define HEADER_PAGE_RECORDS_OFFSET 20 // where its records start
+#define HEADER_PAGE_MAGIC 0x42444d43  // "CMDB"
+#define HEADER_PAGE_VERSION 1         // bumped with every format change
+#define DEFAULT_PAGE_SIZE 512     // page size of new database files
+#define MIN_PAGE_SIZE 512         // page sizes are powers of two in between
+#define MAX_PAGE_SIZE 65536
 #define LOG_BUFFER_SIZE                                                            \
   ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE) // size of a log buffer in byte
 #define BUCKET_SIZE 50                 // size of extendible hash bucket
 #define BUFFER_POOL_SIZE 10            // size of buffer pool
+#define LRUK_REPLACER_K 2              // default lookback of LRU-K replacer
+#define SCAN_RING_SIZE 4               // frames recycled by a sequential scan
+#define CLEANER_BATCH_SIZE 4           // pages written per page cleaner round
+#define OPTIMISTIC_READ_RETRIES 4      // optimistic descents before latching
+#define STATS_STRIPES 16               // per-thread stripes of pool statistics
+#define STATS_LATENCY_BUCKETS 32       // log2 buckets of latency histograms
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024) // huge page size of the platform
+#define FRAME_ARENA_HUGETLB 1          // try MAP_HUGETLB for frame memory
+#define DISK_WRITE_VERSION_STRIPES 64  // seqlock stripes over page writes
+#define CACHE_LINE_SIZE 64             // cache line size of the platform
 
 typedef int32_t page_id_t; // page id type
+typedef int32_t frame_id_t; // buffer pool frame id type
 typedef int32_t txn_id_t;  // transaction id type
 typedef int32_t lsn_t;     // log sequence number type
 
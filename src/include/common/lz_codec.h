@@ -0,0 +1,34 @@
+/**
+ * lz_codec.h
+ *
+ * A small LZ77 codec in the spirit of LZ4: greedy matching through a hash
+ * table of 4-byte sequences, no entropy coding, so both directions run at
+ * memory speed. Meant for pages, i.e. inputs of at most a few ten KB.
+ *
+ * Format: a sequence of
+ *  -----------------------------------------------------------------------
+ * | token (1) | literal length (0+) | literals | offset (2) | match length |
+ *  -----------------------------------------------------------------------
+ * The high nibble of the token is the number of literals, the low nibble
+ * the match length minus 4; a nibble of 15 continues in extra bytes that are
+ * added up until one is below 255. The offset (little endian) points back
+ * into the output. The last sequence has literals only and ends the input.
+ */
+
+#pragma once
+
+namespace cmudb {
+
+class LZCodec {
+public:
+  // compress src_size bytes of src into dst. Returns the compressed size, 0
+  // if it does not fit into dst_capacity bytes
+  static int Compress(const char *src, int src_size, char *dst,
+                      int dst_capacity);
+  // decompress src_size bytes of src into dst. Returns the decompressed
+  // size, -1 if src is malformed or does not fit into dst_capacity bytes
+  static int Decompress(const char *src, int src_size, char *dst,
+                        int dst_capacity);
+};
+
+} // namespace cmudb
@@ -47,6 +47,19 @@ public:
     reader_count_++;
   }
 
+  // turn a read lock of the caller into the write lock, unless a writer
+  // has already entered: it waits for our read lock, we would wait for it
+  bool TryUpgrade() {
+    std::unique_lock<mutex_t> lock(mutex_);
+    if (writer_entered_)
+      return false;
+    writer_entered_ = true;
+    reader_count_--;
+    while (reader_count_ > 0)
+      writer_.wait(lock);
+    return true;
+  }
+
   void RUnlock() {
     std::lock_guard<mutex_t> guard(mutex_);
     reader_count_--;
@@ -0,0 +1,45 @@
+/**
+ * cache_disk_manager.h
+ *
+ * Disk manager of a victim cache file: a scratch file of a fixed number of
+ * page sized slots, meant to live on a fast local device while the database
+ * file does not. The file is created (or truncated) on open and removed on
+ * close, its content does not survive a restart.
+ */
+
+#pragma once
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class CacheDiskManager {
+public:
+  CacheDiskManager(const std::string &file_name, size_t num_slots);
+  ~CacheDiskManager();
+
+  // false if the file could not be created
+  inline bool IsOpen() const { return cache_io_.is_open(); }
+  inline size_t GetNumSlots() const { return num_slots_; }
+
+  void WriteSlot(size_t slot, const char *page_data);
+  void ReadSlot(size_t slot, char *page_data);
+
+  int GetNumReads() const;
+  int GetNumWrites() const;
+
+private:
+  std::fstream cache_io_;
+  std::string file_name_;
+  size_t num_slots_;
+  // single cursor, seek + read/write must not interleave
+  std::mutex cache_io_latch_;
+  std::atomic<int> num_reads_;
+  std::atomic<int> num_writes_;
+};
+
+} // namespace cmudb
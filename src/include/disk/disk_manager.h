@@ -11,19 +11,40 @@
 #include <atomic>
 #include <fstream>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include "common/config.h"
+#include "disk/mapped_file.h"
 
 namespace cmudb {
 
 class DiskManager {
+  friend class MappedFile;
+
 public:
-  DiskManager(const std::string &db_file);
+  DiskManager(const std::string &db_file,
+              int page_size = DEFAULT_PAGE_SIZE);
   ~DiskManager();
 
   void WritePage(page_id_t page_id, const char *page_data);
   void ReadPage(page_id_t page_id, char *page_data);
+  // read num_pages consecutive pages starting at first_page_id in one go,
+  // page i into page_data[i]
+  void ReadPages(page_id_t first_page_id, size_t num_pages,
+                 char *const *page_data);
+  // write num_pages consecutive pages starting at first_page_id in one go,
+  // handed to the file once at the end. Like WritePage this only reaches
+  // the OS page cache
+  void WritePages(page_id_t first_page_id, size_t num_pages,
+                  const char *const *page_data);
+  // make every page written so far durable (fdatasync)
+  void Sync();
+
+  // map the database file read-only for scans, with every page written so
+  // far. nullptr if the file cannot be mapped
+  std::shared_ptr<MappedFile> MapFile();
 
   void WriteLog(char *log_data, int size);
   bool ReadLog(char *log_data, int size, int offset);
@@ -32,22 +53,49 @@ public:
   void DeallocatePage(page_id_t page_id);
 
   int GetNumFlushes() const;
+  int GetNumReads() const;
+  int GetNumReadRequests() const;
+  int GetNumWriteRequests() const;
   bool GetFlushState() const;
+  static bool IsValidPageSize(int page_size);
   inline void SetFlushLogFuture(std::future<void> *f) { flush_log_f_ = f; }
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
 private:
-  int GetFileSize(const std::string &name);
+  long GetFileSize(const std::string &name);
+  void UsePageSize(int page_size);
+  // seqlock over page writes for readers of a MappedFile: a write makes the
+  // version of its pages odd until it reached the file
+  void BumpPageVersions(page_id_t first_page_id, size_t num_pages);
+  uint64_t ReadPageVersion(page_id_t page_id) const;
+  bool ValidatePageVersion(page_id_t page_id, uint64_t version) const;
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
   // stream to write db file
   std::fstream db_io_;
+  // descriptor of the db file for Sync, the stream does not expose its own
+  int db_fd_;
   std::string file_name_;
+  // the buffer pool does page I/O from many threads at once, db_io_ keeps a
+  // single cursor so seek + read/write must not interleave
+  std::mutex db_io_latch_;
   std::atomic<page_id_t> next_page_id_;
   int num_flushes_;
+  std::atomic<int> num_reads_; // page reads, for tests
+  std::atomic<int> num_read_requests_; // ReadPage/ReadPages calls, for tests
+  std::atomic<int> num_write_requests_; // WritePage/WritePages calls
+  // page write versions, page i has stripe i % DISK_WRITE_VERSION_STRIPES
+  std::atomic<uint64_t> page_versions_[DISK_WRITE_VERSION_STRIPES];
   bool flush_log_;
   std::future<void> *flush_log_f_;
+  // log buffer of the last WriteLog, the log manager must alternate buffers.
+  // Per instance: a new log manager may get a freed buffer address back
+  char *buffer_used_;
+  // DiskManagers alive, PAGE_SIZE is theirs
+  static std::mutex open_latch_;
+  static int num_open_;
 };
 
 } // namespace cmudb
\ No newline at end of file
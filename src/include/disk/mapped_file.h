@@ -0,0 +1,57 @@
+/**
+ * mapped_file.h
+ *
+ * Read-only memory mapping of a database file, for large scans that read
+ * pages straight from the OS page cache instead of through buffer pool
+ * frames (see TableHeap::MappedBegin). The mapping covers the pages the file
+ * had when it was mapped and is advised for sequential access, so the kernel
+ * reads ahead and drops pages behind the scan.
+ *
+ * The mapping shows the file, not the buffer pool: a page the pool holds may
+ * be newer than what the mapping shows, a reader has to ask the pool first.
+ * A page may also be written to the file while it is read from the mapping;
+ * the disk manager keeps a seqlock over its page writes for that, a read is
+ * only consistent if ValidateVersion succeeds with the version taken before.
+ *
+ * Made by DiskManager::MapFile, must not outlive its disk manager.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "common/config.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+class DiskManager;
+
+class MappedFile {
+public:
+  MappedFile(const std::string &file_name, DiskManager *disk_manager);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // false if the file could not be mapped, e.g. because it is empty
+  inline bool IsMapped() const { return data_ != nullptr; }
+  inline page_id_t GetNumPages() const { return num_pages_; }
+
+  // point view at page_id in the mapping, false if the mapping does not
+  // cover it. The view is read-only, writing to its data faults
+  bool View(page_id_t page_id, Page &view) const;
+
+  // seqlock over the writes of page_id to the file, see DiskManager
+  uint64_t ReadVersion(page_id_t page_id) const;
+  bool ValidateVersion(page_id_t page_id, uint64_t version) const;
+
+private:
+  DiskManager *disk_manager_;
+  char *data_;
+  size_t mapped_size_;
+  page_id_t num_pages_;
+};
+
+} // namespace cmudb
@@ -2,33 +2,50 @@
  * extendible_hash.h : implementation of in-memory hash table using extendible
  * hashing
  *
- * Functionality: The buffer pool manager must maintain a page table to be able
- * to quickly map a PageId to its corresponding memory location; or alternately
- * report that the PageId does not match any currently-buffered page.
+ * Functionality: A general in-memory hash table that many threads may use at
+ * once. The directory has a reader-writer latch and every bucket has its own
+ * one: Find takes both in shared mode, Insert and Remove hold the directory
+ * latch shared and write latch only their bucket. A split happens under the
+ * latch of the bucket that overflowed alone; the directory latch is only
+ * taken exclusively to double the directory when the global depth grows.
+ *
+ * Directory slots are atomic bucket pointers. A split may repoint the slots
+ * of its bucket while other threads look at them, so whoever latched a
+ * bucket checks that its slot still points there and starts over if not.
+ * Buckets are never freed before the table is, a stale pointer stays valid.
+ *
+ * A bucket is one block of memory: a header, then a fixed number of slots
+ * as flat arrays of fingerprints, keys and values. Its entries are the
+ * first slots, and every slot has a one byte fingerprint taken from the top
+ * bits of the hash (0 for a free slot). A lookup compares the fingerprints
+ * of a whole group of slots at once with SSE2/AVX2 and only looks at the
+ * keys whose fingerprint matched, so it mostly touches the fingerprint cache
+ * line and the one of its key.
  */
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
-#include <vector>
+#include <mutex>
 #include <string>
-#include <map>
-
-// Below fix the error: ‘shared_ptr’ is not a member of ‘std’
-#include <memory> 
+#include <vector>
 
-#include <mutex>
+#include "common/rwmutex.h"
 #include "hash/hash_table.h"
-#include <math.h>       /* pow */
 
 namespace cmudb {
 
 template <typename K, typename V>
 class ExtendibleHash : public HashTable<K, V> {
 public:
-  // constructor
+  // constructor, size: most entries of one bucket
   ExtendibleHash(size_t size);
-  // helper function to generate hash addressing
+  ~ExtendibleHash();
+  // helper function to generate hash addressing: std::hash of the key, mixed
+  // so that every bit depends on all of its bits (std::hash of an integer
+  // is the integer itself)
   size_t HashKey(const K &key);
   // helper function to get global & local depth
   int GetGlobalDepth() const;
@@ -39,33 +56,42 @@ public:
   bool Remove(const K &key) override;
   void Insert(const K &key, const V &value) override;
 
+private:
+  // header of a bucket, its slot arrays follow it in the same block
   struct Bucket {
-    Bucket() = default;
-    Bucket(int depth, int id) 
-    : mLocalDepth(depth), mId(id)
-    {}
-    int mLocalDepth = 0;
-    int mId = 0;
-    // std::array must be a compile-time constant. We use vector instead
-    std::map<K,V> dataMap;
+    int local_depth_ = 0; // changed only under latch_
+    size_t size_ = 0;     // entries, in the first size_ slots
+    // padded to a whole number of probe groups, the padding stays 0
+    uint8_t *fingerprints_ = nullptr;
+    K *keys_ = nullptr;
+    V *values_ = nullptr;
+    RWMutex latch_;
   };
 
-private:
-  // add your own member variables here
-  size_t GetBucketIndexFromHash(size_t hash);
-
-  void Split(size_t index, const K &key, const V &value);
-
-  size_t GetDirCapacity() const { return pow(2, mDepth); }
-  // total num of bits needed to express the total num of buckets
-  int mDepth; // gloabl depth
-
-  int mBucketCount;
-  size_t mBucketDataSize;
-  std::vector<std::shared_ptr<Bucket>> mDirectory;
-  mutable std::mutex mutex_;  
-
-  void dump(const K &key);
+  inline size_t IndexOf(size_t hash) const {
+    return hash & ((static_cast<size_t>(1) << global_depth_) - 1);
+  }
+  static inline uint8_t FingerprintOf(size_t hash) {
+    // top bits, the directory uses the bottom ones; never 0
+    return static_cast<uint8_t>((hash >> (sizeof(size_t) * 8 - 7)) | 0x80);
+  }
+  static int FindSlot(const Bucket *bucket, const K &key,
+                      uint8_t fingerprint);
+  static void ClearSlot(Bucket *bucket, size_t slot);
+  Bucket *NewBucket(int local_depth);
+  void FreeBucket(Bucket *bucket);
+  Bucket *LatchBucket(size_t index, bool exclusive);
+  void Split(Bucket *bucket, size_t index);
+  void Grow(int global_depth);
 
+  size_t bucket_size_;
+  // number of low hash bits that index the directory, changed only under
+  // the write latch of the directory
+  int global_depth_;
+  std::vector<std::atomic<Bucket *>> directory_;
+  mutable RWMutex directory_latch_;
+  // every bucket ever made, splits append to it; freed with the table
+  std::vector<Bucket *> buckets_;
+  std::mutex buckets_latch_;
 };
 } // namespace cmudb
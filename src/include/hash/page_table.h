@@ -0,0 +1,80 @@
+/**
+ * page_table.h
+ *
+ * Functionality: Open-addressing hash table mapping page ids to the ids of
+ * the buffer pool frames holding them. Every slot is one atomic 64-bit word
+ * packing (page id, frame id), so a lookup is a lock-free linear probe over
+ * a cache-line-aligned array: no mutex, no pointer chasing, and a reader
+ * never sees a page id paired with the wrong frame.
+ *
+ * Insert and Remove may be called from many threads, they are serialized by
+ * a writer mutex. Removed entries leave tombstones, which keeps concurrent
+ * probes intact; when tombstones pile up the writer rehashes the array in
+ * place inside a sequence lock, and a lookup that missed while a rehash was
+ * running retries. Reserve grows the table for a bigger pool the same way,
+ * into a new array; old arrays are kept until the table is destroyed, since
+ * a reader may still be probing them.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "hash/hash_table.h"
+
+namespace cmudb {
+
+class PageTable : public HashTable<page_id_t, frame_id_t> {
+public:
+  // max_entries: most pages mapped at once (the pool size)
+  explicit PageTable(size_t max_entries);
+  ~PageTable();
+
+  bool Find(const page_id_t &page_id, frame_id_t &frame_id) override;
+  bool Remove(const page_id_t &page_id) override;
+  void Insert(const page_id_t &page_id, const frame_id_t &frame_id) override;
+
+  // make room for max_entries mappings, the table never shrinks
+  void Reserve(size_t max_entries);
+
+  inline size_t GetCapacity() const { return capacity_; }
+
+private:
+  static inline uint64_t Pack(page_id_t page_id, frame_id_t frame_id) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) |
+           static_cast<uint32_t>(frame_id);
+  }
+  static inline page_id_t KeyOf(uint64_t slot) {
+    return static_cast<page_id_t>(slot >> 32);
+  }
+  static inline frame_id_t FrameOf(uint64_t slot) {
+    return static_cast<frame_id_t>(slot & 0xffffffff);
+  }
+
+  static std::atomic<uint64_t> *AllocateSlots(size_t capacity);
+  static inline size_t SlotOf(page_id_t page_id, size_t mask) {
+    // Fibonacci hashing: page ids are mostly consecutive, the multiply
+    // spreads them and the top bits pick the slot
+    uint64_t hash = static_cast<uint32_t>(page_id) * 0x9E3779B97F4A7C15ULL;
+    return (hash >> 32) & mask;
+  }
+  bool Probe(page_id_t page_id, frame_id_t &frame_id) const;
+  void Rehash(std::atomic<uint64_t> *slots, size_t capacity);
+
+  // capacity_ is only used by writers; readers go by mask_, which is
+  // published after slots_, so they never probe past the array they see
+  size_t capacity_; // number of slots, a power of two
+  std::atomic<size_t> mask_;
+  std::atomic<std::atomic<uint64_t> *> slots_;
+  std::vector<std::atomic<uint64_t> *> retired_; // arrays replaced by Reserve
+  size_t size_;       // live entries, protected by write_latch_
+  size_t tombstones_; // protected by write_latch_
+  std::atomic<uint64_t> version_; // odd while a rehash is running
+  std::mutex write_latch_;
+};
+
+} // namespace cmudb
@@ -10,6 +10,7 @@
  */
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <vector>
 
@@ -35,11 +36,12 @@ public:
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
-  // Insert a key-value pair into this B+ tree.
+  // Insert a key-value pair into this B+ tree. Without a transaction the
+  // pages are latched all the same, lookups run optimistically against it
   bool Insert(const KeyType &key, const ValueType &value,
               Transaction *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and its value from this B+ tree, latched like Insert
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
   // return the value associated with a given key
@@ -65,6 +67,10 @@ public:
                   Transaction *transaction = nullptr, OpType op = SEARCH, bool leftMost = false);
 
 private:
+  bool OptimisticFindLeaf(const KeyType &key, Page *&leaf, uint64_t &version);
+
+  void KeepResident(Page *page);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value,
@@ -98,7 +104,9 @@ private:
 
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  // read by optimistic lookups without any latch, a new root is only
+  // published once it is fully set up
+  std::atomic<page_id_t> root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
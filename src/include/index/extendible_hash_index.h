@@ -0,0 +1,45 @@
+/**
+ * extendible_hash_index.h
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "index/extendible_hash_table.h"
+#include "index/index.h"
+
+namespace cmudb {
+
+#define EXTENDIBLE_HASH_INDEX_TYPE                                             \
+  ExtendibleHashIndex<KeyType, ValueType, KeyComparator>
+
+// equality lookups only, see ExtendibleHashTable
+INDEX_TEMPLATE_ARGUMENTS
+class ExtendibleHashIndex : public Index {
+
+public:
+  ExtendibleHashIndex(IndexMetadata *metadata,
+                      BufferPoolManager *buffer_pool_manager,
+                      page_id_t header_page_id = INVALID_PAGE_ID);
+
+  ~ExtendibleHashIndex() {}
+
+  void InsertEntry(const Tuple &key, RID rid,
+                   Transaction *transaction = nullptr) override;
+
+  void DeleteEntry(const Tuple &key,
+                   Transaction *transaction = nullptr) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> &result,
+               Transaction *transaction = nullptr) override;
+
+protected:
+  // comparator for key
+  KeyComparator comparator_;
+  // container
+  ExtendibleHashTable<KeyType, ValueType, KeyComparator> container_;
+};
+
+} // namespace cmudb
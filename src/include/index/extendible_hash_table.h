@@ -0,0 +1,81 @@
+/**
+ * extendible_hash_table.h
+ *
+ * Disk-resident extendible hash table for equality lookups, every page of it
+ * lives in the buffer pool. A key is found by its 32 bit hash in three page
+ * accesses whatever the size of the table: the header page picks one of its
+ * directory pages by the top bits of the hash, the directory picks a bucket
+ * page by the bottom bits. The header and directory pages are kept in the
+ * pool with high priority, so a lookup mostly reads only its bucket.
+ * (1) We only support unique key
+ * (2) A full bucket splits in two and the directory doubles when needed,
+ *     both are written to their pages. Buckets are never merged, a table
+ *     does not shrink
+ * (3) Latches are taken top down: the directory page, then its buckets.
+ *     Insert first tries with the directory read latched and only write
+ *     latches it to split
+ *
+ * Keys are hashed by KeyComparator::Hash, which agrees with the comparator
+ * on equal keys. The hash function is part of the file format, it must not
+ * change.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "concurrency/transaction.h"
+#include "page/hash_table_bucket_page.h"
+#include "page/hash_table_directory_page.h"
+#include "page/hash_table_header_page.h"
+
+namespace cmudb {
+
+#define HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class ExtendibleHashTable {
+public:
+  // header_page_id is the first page of an existing table. A new table is
+  // made without it, and its header page id recorded in the database header
+  // page under name
+  explicit ExtendibleHashTable(const std::string &name,
+                               BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator,
+                               page_id_t header_page_id = INVALID_PAGE_ID);
+
+  // Insert a key-value pair, false if the key is there already. Throws if
+  // its bucket is full and cannot split any more
+  bool Insert(const KeyType &key, const ValueType &value,
+              Transaction *transaction = nullptr);
+
+  // Remove a key and its value from this table.
+  void Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+  // return the value associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> &result,
+                Transaction *transaction = nullptr);
+
+  page_id_t GetHeaderPageId() const { return header_page_id_; }
+
+  // expose for test purpose: global depth of the directory of a hash, -1 if
+  // it has none yet
+  int GetGlobalDepth(uint32_t hash);
+  uint32_t Hash(const KeyType &key) const;
+
+private:
+  page_id_t GetDirectoryPageId(uint32_t hash, bool create);
+  bool SplitBucket(WritePageGuard &directory_guard,
+                   WritePageGuard &bucket_guard, uint32_t bucket_idx);
+  void KeepResident(Page *page);
+  ReadPageGuard LatchRead(page_id_t page_id);
+  WritePageGuard LatchWrite(page_id_t page_id);
+
+  // member variable
+  std::string index_name_;
+  page_id_t header_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+};
+
+} // namespace cmudb
@@ -83,6 +83,62 @@ public:
     return 0;
   }
 
+  // hash that agrees with operator(): keys that compare equal hash equal.
+  // It hashes the column values as they are compared, not the key bytes:
+  // a DECIMAL -0.0 is 0.0, a VARCHAR is its characters. The result is not
+  // mixed, callers that index by some of its bits mix it first
+  inline uint64_t Hash(const GenericKey<KeySize> &key) const {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    int column_count = key_schema_->GetColumnCount();
+
+    for (int i = 0; i < column_count; i++) {
+      Value value = key.ToValue(key_schema_, i);
+      if (value.IsNull()) {
+        // a null compares equal to anything, no hash can agree with that
+        hash = Combine(hash, 0);
+        continue;
+      }
+      switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        hash = Combine(hash, value.GetAs<int8_t>());
+        break;
+      case TypeId::SMALLINT:
+        hash = Combine(hash, value.GetAs<int16_t>());
+        break;
+      case TypeId::INTEGER:
+        hash = Combine(hash, value.GetAs<int32_t>());
+        break;
+      case TypeId::DECIMAL: {
+        double decimal = value.GetAs<double>();
+        uint64_t bits = 0;
+        if (decimal != decimal) {
+          bits = ~static_cast<uint64_t>(0); // every NaN alike
+        } else {
+          decimal += 0.0; // -0.0 becomes 0.0
+          memcpy(&bits, &decimal, sizeof(bits));
+        }
+        hash = Combine(hash, bits);
+        break;
+      }
+      case TypeId::VARCHAR: {
+        const char *data = value.GetData();
+        // the length counts the terminating 0
+        for (uint32_t j = 0; j + 1 < value.GetLength(); j++) {
+          hash = Combine(hash, static_cast<uint8_t>(data[j]));
+        }
+        hash = Combine(hash, value.GetLength());
+        break;
+      }
+      default:
+        // BIGINT, TIMESTAMP
+        hash = Combine(hash, value.GetAs<int64_t>());
+        break;
+      }
+    }
+    return hash;
+  }
+
   GenericComparator(const GenericComparator &other) {
     this->key_schema_ = other.key_schema_;
   }
@@ -91,6 +147,14 @@ public:
   GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
 
 private:
+  static const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+  static const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+  // one FNV-1a step, on a whole word
+  static inline uint64_t Combine(uint64_t hash, uint64_t word) {
+    return (hash ^ word) * FNV_PRIME;
+  }
+
   Schema *key_schema_;
 };
 
@@ -14,6 +14,10 @@
 
 namespace cmudb {
 
+// structure behind an index: B+ tree for range and equality lookups, hash
+// for equality lookups only
+enum class IndexType { BPLUSTREE = 0, HASH };
+
 /**
  * class IndexMetadata - Holds metadata of an index object
  *
@@ -28,8 +32,10 @@ class IndexMetadata {
 
 public:
   IndexMetadata(std::string index_name, std::string table_name,
-                const Schema *tuple_schema, const std::vector<int> &key_attrs)
-      : name_(index_name), table_name_(table_name), key_attrs_(key_attrs) {
+                const Schema *tuple_schema, const std::vector<int> &key_attrs,
+                IndexType index_type = IndexType::BPLUSTREE)
+      : name_(index_name), table_name_(table_name), key_attrs_(key_attrs),
+        index_type_(index_type) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
   }
 
@@ -39,6 +45,8 @@ public:
 
   inline const std::string &GetTableName() { return table_name_; }
 
+  inline IndexType GetIndexType() const { return index_type_; }
+
   // Returns a schema object pointer that represents the indexed key
   inline Schema *GetKeySchema() const { return key_schema_; }
 
@@ -57,7 +65,8 @@ public:
 
     os << "IndexMetadata["
        << "Name = " << name_ << ", "
-       << "Type = B+Tree, "
+       << "Type = "
+       << (index_type_ == IndexType::HASH ? "Hash" : "B+Tree") << ", "
        << "Table name = " << table_name_ << "] :: ";
     os << key_schema_->ToString();
 
@@ -69,6 +78,7 @@ private:
   std::string table_name_;
   // The mapping relation between key schema and tuple schema
   const std::vector<int> key_attrs_;
+  IndexType index_type_;
   // schema of the indexed key
   Schema *key_schema_;
 };
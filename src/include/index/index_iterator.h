@@ -3,6 +3,8 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <memory>
+
 #include "page/b_plus_tree_leaf_page.h"
 #include "buffer/buffer_pool_manager.h"
 //#include "common/logger.h"
@@ -45,8 +47,12 @@ public:
       } else {
         index_ = 0;
         buff_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
-        leaf_ =
-            reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *> (buff_pool_manager_->FetchPage(next)->GetData());
+        leaf_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(
+            buff_pool_manager_
+                ->FetchPage(next, AccessType::SEQUENTIAL_SCAN, strategy_.get())
+                ->GetData());
+        // read ahead one leaf
+        buff_pool_manager_->PrefetchPage(leaf_->GetNextPageId(), strategy_);
         
       }
     }
@@ -58,6 +64,8 @@ private:
   BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf_;
   int index_;
   BufferPoolManager *buff_pool_manager_;
+  // leaves are read once per range scan, through a private ring of frames
+  std::shared_ptr<BufferAccessStrategy> strategy_;
 };
 
 
@@ -48,10 +48,13 @@ public:
   void task1();
   void SwapBuffer();
   void wakeUpFlushThread();
-  
+  // block until the log is persistent up to lsn, see log_manager.cpp
+  void WaitForPersistentLSN(lsn_t lsn);
+
 private:
   // TODO: you may add your own member variables
   // also remember to change constructor accordingly
+  void RequestFlush();
 
   // atomic counter, record the next log sequence number
   std::atomic<lsn_t> next_lsn_;
@@ -66,6 +69,8 @@ private:
   std::thread *flush_thread_;
   // for notifying flush thread
   std::condition_variable cv_;
+  // the flush thread wrote the flush buffer
+  std::condition_variable flushed_cv_;
   // disk manager
   DiskManager *disk_manager_;
 
@@ -0,0 +1,62 @@
+/**
+ * hash_table_bucket_page.h
+ *
+ * Bucket of a disk-resident extendible hash table: the key and record id of
+ * every entry whose hash leads to it, unordered. Only support unique key.
+ *
+ * Bucket page format:
+ *  ----------------------------------------------------------------------
+ * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ *  ----------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 16 bytes in total):
+ *  ---------------------------------------------------------------
+ * | PageId (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------
+ */
+#pragma once
+
+#include <utility>
+
+#include "page/b_plus_tree_page.h"
+
+namespace cmudb {
+#define HASH_TABLE_BUCKET_PAGE_TYPE                                            \
+  HashTableBucketPage<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class HashTableBucketPage {
+public:
+  // After creating a new bucket page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id);
+
+  page_id_t GetPageId() const { return page_id_; }
+  int GetSize() const { return size_; }
+  int GetMaxSize() const { return max_size_; }
+  bool IsFull() const { return size_ >= max_size_; }
+
+  KeyType KeyAt(int index) const;
+  ValueType ValueAt(int index) const;
+
+  bool Lookup(const KeyType &key, ValueType &value,
+              const KeyComparator &comparator) const;
+  // false if the key is there already or the bucket is full
+  bool Insert(const KeyType &key, const ValueType &value,
+              const KeyComparator &comparator);
+  // false if the key is not there
+  bool Remove(const KeyType &key, const KeyComparator &comparator);
+  // the last entry takes the place of the removed one
+  void RemoveAt(int index);
+
+private:
+  int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
+
+  page_id_t page_id_;
+  lsn_t lsn_;
+  int size_;
+  int max_size_;
+  MappingType array_[0];
+};
+
+} // namespace cmudb
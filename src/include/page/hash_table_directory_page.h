@@ -0,0 +1,81 @@
+/**
+ * hash_table_directory_page.h
+ *
+ * Directory of a disk-resident extendible hash table: its first 2^GlobalDepth
+ * slots hold the page id of the bucket that the keys whose hash ends in the
+ * slot number go to, and the local depth of that bucket, i.e. how many of
+ * those bottom bits all of its keys share. A bucket of local depth d is in
+ * the 2^(GlobalDepth - d) slots that agree on the bottom d bits.
+ *
+ * MaxDepth is as large as PAGE_SIZE allows, the global depth never grows
+ * past it.
+ *
+ * Format (size in byte):
+ *  -------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | MaxDepth (4) | GlobalDepth (4) |
+ *  -------------------------------------------------------------------
+ *  -------------------------------------------------------------------
+ * | LocalDepths (1 * 2^MaxDepth) | BucketPageIds (4 * 2^MaxDepth) |
+ *  -------------------------------------------------------------------
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class HashTableDirectoryPage {
+public:
+  // After creating a new directory page from buffer pool, must call
+  // initialize method to set default values. A new directory has one slot,
+  // which points to bucket_page_id
+  void Init(page_id_t page_id, page_id_t bucket_page_id);
+
+  page_id_t GetPageId() const { return page_id_; }
+  uint32_t GetMaxDepth() const { return max_depth_; }
+  uint32_t GetGlobalDepth() const { return global_depth_; }
+  // number of slots in use, 2^GlobalDepth
+  uint32_t Size() const { return 1u << global_depth_; }
+
+  // slot of the bucket a hash belongs to
+  uint32_t HashToBucketIndex(uint32_t hash) const;
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const;
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id);
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const;
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth);
+
+  // double the slots, the new half points to the same buckets as the old
+  // one. Only while GlobalDepth < MaxDepth
+  void IncrGlobalDepth();
+
+private:
+  // both arrays are sized by max_depth_, which only Init sets
+  inline uint8_t *LocalDepths() {
+    return reinterpret_cast<uint8_t *>(this) + sizeof(HashTableDirectoryPage);
+  }
+  inline const uint8_t *LocalDepths() const {
+    return reinterpret_cast<const uint8_t *>(this) +
+           sizeof(HashTableDirectoryPage);
+  }
+  // after the local depths, padded to the alignment of a page id
+  inline page_id_t *BucketPageIds() {
+    return reinterpret_cast<page_id_t *>(LocalDepths() + LocalDepthsSize());
+  }
+  inline const page_id_t *BucketPageIds() const {
+    return reinterpret_cast<const page_id_t *>(LocalDepths() +
+                                               LocalDepthsSize());
+  }
+  inline size_t LocalDepthsSize() const {
+    return ((static_cast<size_t>(1) << max_depth_) + sizeof(page_id_t) - 1) &
+           ~(sizeof(page_id_t) - 1);
+  }
+
+  page_id_t page_id_;
+  lsn_t lsn_;
+  uint32_t max_depth_;
+  uint32_t global_depth_;
+};
+
+} // namespace cmudb
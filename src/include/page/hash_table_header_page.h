@@ -0,0 +1,48 @@
+/**
+ * hash_table_header_page.h
+ *
+ * First page of a disk-resident extendible hash table. It spreads the keys
+ * over up to 2^MaxDepth directory pages by the top MaxDepth bits of their
+ * hash, so that the table can grow past what one directory page addresses.
+ * A directory page is made the first time a key hashes to it and never
+ * moves afterwards.
+ *
+ * MaxDepth is as large as PAGE_SIZE allows.
+ *
+ * Format (size in byte):
+ *  ------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | MaxDepth (4) | DirectoryPageIds (4 * 2^MaxDepth)
+ *  ------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class HashTableHeaderPage {
+public:
+  // After creating a new header page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id);
+
+  page_id_t GetPageId() const { return page_id_; }
+  uint32_t GetMaxDepth() const { return max_depth_; }
+  // number of directory slots, 2^MaxDepth
+  uint32_t MaxSize() const { return 1u << max_depth_; }
+
+  // slot of the directory a hash belongs to
+  uint32_t HashToDirectoryIndex(uint32_t hash) const;
+  page_id_t GetDirectoryPageId(uint32_t directory_idx) const;
+  void SetDirectoryPageId(uint32_t directory_idx, page_id_t directory_page_id);
+
+private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  uint32_t max_depth_;
+  page_id_t directory_page_ids_[0];
+};
+
+} // namespace cmudb
@@ -5,10 +5,18 @@
  * our case, we will contain information about table/index name (length less than
  * 32 bytes) and their corresponding root_id
  *
+ * It also records the page size of the database file, which DiskManager
+ * reads when opening the file; LSN is the page LSN slot every page has.
+ * Magic and Version tell the format: DiskManager refuses a file with a
+ * header page of another version, and opening a database file whose header
+ * page has no magic fails, its records would be read from the wrong place.
+ *
  * Format (size in byte):
- *  -----------------------------------------------------------------
- * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
- *  -----------------------------------------------------------------
+ *  ----------------------------------------------------------------------
+ * | RecordCount (4) | LSN (4) | PageSize (4) | Magic (4) | Version (4) |
+ *  ----------------------------------------------------------------------
+ * | Entry_1 name (32) | Entry_1 root_id (4) | ... |
+ *  -----------------------------------------------
  */
 
 #pragma once
@@ -21,7 +29,11 @@ namespace cmudb {
 
 class HeaderPage : public Page {
 public:
-  void Init() { SetRecordCount(0); }
+  void Init() {
+    SetRecordCount(0);
+    SetPageSize(PAGE_SIZE);
+    SetFormat();
+  }
   /**
    * Record related
    */
@@ -32,6 +44,9 @@ public:
   // return root_id if success
   bool GetRootId(const std::string &name, page_id_t &root_id);
   int GetRecordCount();
+  int GetPageSize();
+  // false for a header page written before the current format, or none
+  bool IsCurrentFormat();
 
 private:
   /**
@@ -40,5 +55,7 @@ private:
   int FindRecord(const std::string &name);
 
   void SetRecordCount(int record_count);
+  void SetPageSize(int page_size);
+  void SetFormat();
 };
 } // namespace cmudb
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
 #include <iostream>
 
@@ -16,23 +18,81 @@
 
 namespace cmudb {
 
-class Page {
+// eviction class of a page: the buffer pool only evicts a HIGH page when no
+// NORMAL page can be evicted
+enum class PagePriority : uint8_t { NORMAL = 0, HIGH };
+
+// the latches of a buffer pool frame. They are much bigger than the rest of
+// the frame metadata, so they live in an array of their own (see FrameArena)
+// and bookkeeping scans over the Page objects do not touch them
+struct FrameLatch {
+  // waited on (with the pool latch) until io_in_progress_ is cleared
+  std::condition_variable io_cv_;
+  RWMutex rwlatch_;
+};
+
+// one cache line per page: pins and unpins of neighbouring frames do not
+// contend for the same line
+class alignas(CACHE_LINE_SIZE) Page {
   friend class BufferPoolManager;
+  friend class FrameArena;
+  friend class MappedFile;
 
 public:
-  Page() { ResetMemory(); }
+  // the data and the latches belong to a FrameArena, which points the page
+  // to them, or the data to a MappedFile for a read-only view, which has no
+  // latches
+  Page() {}
   ~Page(){};
   // get actual data page content
   inline char *GetData() { return data_; }
   // get page id
   inline page_id_t GetPageId() { return page_id_; }
-  // get page pin count
-  inline int GetPinCount() { return pin_count_; }
-  // method use to latch/unlatch page content
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
-  inline void WLatch() { rwlatch_.WLock(); }
-  inline void RUnlatch() { rwlatch_.RUnlock(); }
-  inline void RLatch() { rwlatch_.RLock(); }
+  // get page pin count, 0 for a frame without a page
+  inline int GetPinCount() {
+    int pin_count = pin_count_;
+    return pin_count < 0 ? 0 : pin_count;
+  }
+  // get index of the buffer pool frame holding this page
+  inline frame_id_t GetFrameId() { return frame_id_; }
+  // get eviction class, see BufferPoolManager::SetPagePriority
+  inline PagePriority GetPriority() {
+    return priority_.load(std::memory_order_relaxed);
+  }
+  // method use to latch/unlatch page content. A writer makes version_ odd
+  // for as long as it holds the latch
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    latch_->rwlatch_.WUnlock();
+  }
+  inline void WLatch() {
+    latch_->rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  inline void RUnlatch() { latch_->rwlatch_.RUnlock(); }
+  inline void RLatch() { latch_->rwlatch_.RLock(); }
+  // read latch to write latch with no writer in between, false if another
+  // writer is already waiting (see RWMutex::TryUpgrade)
+  inline bool TryUpgradeLatch() {
+    if (!latch_->rwlatch_.TryUpgrade()) {
+      return false;
+    }
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+  }
+  // optimistic read latch: snapshot the version, read the page without any
+  // latch, then validate the snapshot. Whatever was read is only meaningful
+  // if validation succeeds, a snapshot taken under a writer never does
+  inline uint64_t ReadVersion() {
+    return version_.load(std::memory_order_acquire);
+  }
+  inline bool ValidateVersion(uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (version & 1) == 0 &&
+           version_.load(std::memory_order_relaxed) == version;
+  }
 
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + 4); }
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + 4, &lsn, 4); }
@@ -40,12 +100,30 @@ public:
 private:
   // method used by buffer pool manager
   inline void ResetMemory() { memset(data_, 0, PAGE_SIZE); }
+  // pin_count_ of a frame that is free, or that the buffer pool claimed for
+  // another page: it cannot be pinned without the pool latch
+  static constexpr int FRAME_CLAIMED = -1;
+
   // members
-  char data_[PAGE_SIZE]; // actual data
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  int pin_count_ = 0;
+  char *data_ = nullptr; // actual data, PAGE_SIZE bytes in a FrameArena
+  FrameLatch *latch_ = nullptr;
+  // page_id_, pin_count_ and io_in_progress_ are written under the pool
+  // latch and read without it by FetchPage hits
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  frame_id_t frame_id_ = -1;
+  std::atomic<int> pin_count_{FRAME_CLAIMED};
   bool is_dirty_ = false;
-  RWMutex rwlatch_;
+  // pinned by a hit without the pool latch, the replacer learns of the
+  // access on the next unpin
+  std::atomic<bool> accessed_{false};
+  // written under the pool latch, read by pin holders without it
+  std::atomic<PagePriority> priority_{PagePriority::NORMAL};
+  // set while the buffer pool reads/writes this frame without its latch
+  std::atomic<bool> io_in_progress_{false};
+  std::atomic<uint64_t> version_{0}; // bumped by every WLatch and WUnlatch
 };
 
+static_assert(sizeof(Page) <= CACHE_LINE_SIZE,
+              "the frame metadata must fit into one cache line");
+
 } // namespace cmudb
@@ -42,17 +42,32 @@ public:
                    Transaction *txn); // when commit delete or rollback insert
   void RollbackDelete(const RID &rid, Transaction *txn); // when rollback delete
 
-  bool GetTuple(const RID &rid, Tuple &tuple, Transaction *txn);
+  // strategy: set by scans, which read pages through their ring
+  bool GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
+                BufferAccessStrategy *strategy = nullptr);
 
   bool DeleteTableHeap();
 
+  // start reading the pages holding rids, e.g. the result of an index scan
+  void PrefetchTuples(const std::vector<RID> &rids);
+
   TableIterator begin(Transaction *txn);
 
+  // scan for large read-only queries: pages are read straight from a
+  // read-only mapping of the database file instead of through buffer pool
+  // frames, so the scan neither evicts nor copies pages. Pages the pool has
+  // are read there, as are all pages if the file cannot be mapped. A tuple
+  // shows the newest version of its page when it is read, the scan as a
+  // whole is no snapshot
+  TableIterator MappedBegin(Transaction *txn);
+
   TableIterator end();
 
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
 private:
+  RID GetFirstTupleRid();
+
   /**
    * Members
    */
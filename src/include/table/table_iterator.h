@@ -7,19 +7,26 @@
 #pragma once
 
 #include <cassert>
+#include <functional>
+#include <memory>
 
+#include "buffer/buffer_access_strategy.h"
 #include "common/rid.h"
+#include "disk/mapped_file.h"
 #include "table/tuple.h"
 
 namespace cmudb {
 
 class TableHeap;
+class TablePage;
 
 class TableIterator {
   friend class Cursor;
 
 public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  // mapped_file: set by a mapped scan (TableHeap::MappedBegin)
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn,
+                std::shared_ptr<MappedFile> mapped_file = nullptr);
 
   ~TableIterator() { delete tuple_; }
 
@@ -40,9 +47,16 @@ public:
   TableIterator operator++(int);
 
 private:
+  void ReadPage(page_id_t page_id,
+                const std::function<void(TablePage *)> &read);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  // ring of frames the scan recycles, shared by copies of the iterator
+  std::shared_ptr<BufferAccessStrategy> strategy_;
+  // database file a mapped scan reads pages from, shared by copies too
+  std::shared_ptr<MappedFile> mapped_file_;
 };
 
 } // namespace cmudb
\ No newline at end of file
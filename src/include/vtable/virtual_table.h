@@ -8,6 +8,7 @@
 #include "catalog/schema.h"
 #include "concurrency/transaction_manager.h"
 #include "index/b_plus_tree_index.h"
+#include "index/extendible_hash_index.h"
 #include "logging/log_manager.h"
 #include "sqlite/sqlite3ext.h"
 #include "table/table_heap.h"
@@ -18,6 +19,7 @@ namespace cmudb {
 /* Helpers */
 Schema *ParseCreateStatement(const std::string &sql);
 
+// "index_name [using btree|hash] column, ...", a B+ tree by default
 IndexMetadata *ParseIndexStatement(std::string &sql,
                                    const std::string &table_name,
                                    Schema *schema);
@@ -62,17 +64,20 @@ int VtabBegin(sqlite3_vtab *pVTab);
 // storage engine
 class StorageEngine {
 public:
-  StorageEngine(std::string db_file_name) {
+  // page_size only matters for a new database file
+  StorageEngine(std::string db_file_name, int page_size = DEFAULT_PAGE_SIZE) {
     ENABLE_LOGGING = false;
 
     // storage related
-    disk_manager_ = new DiskManager(db_file_name);
+    disk_manager_ = new DiskManager(db_file_name, page_size);
 
     // log related
     log_manager_ = new LogManager(disk_manager_);
 
     buffer_pool_manager_ =
         new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    // every table and index is opened through the header page
+    buffer_pool_manager_->SetPagePriority(HEADER_PAGE_ID, PagePriority::HIGH);
 
     // txn related
     lock_manager_ = new LockManager(true); // S2PL
@@ -80,6 +85,8 @@ public:
   }
 
   ~StorageEngine() {
+    // pages first: while logging is on their writes wait for the log (WAL)
+    buffer_pool_manager_->FlushAllPages();
     if (ENABLE_LOGGING)
       log_manager_->StopFlushThread();
     delete disk_manager_;
@@ -250,6 +257,7 @@ public:
   // wrapper around poit scan methods
   inline void ScanKey(const Tuple &key) {
     virtual_table_->index_->ScanKey(key, results);
+    virtual_table_->table_heap_->PrefetchTuples(results);
   }
 
 private:
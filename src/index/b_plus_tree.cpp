@@ -59,13 +59,42 @@ void BPLUSTREE_TYPE::UnLockUnPinPages(Transaction *transaction, OpType op, bool
 /*
  * Return the only value that associated with input key
  * This method is used for point query
+ * Lookups run optimistically, without any page latch; only after
+ * OPTIMISTIC_READ_RETRIES descents that collided with a writer do they fall
+ * back to latching
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key,
                               std::vector<ValueType> &result,
                               Transaction *transaction) {
-  
+  for (int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES; ++attempt) {
+    Page *rawLeaf = nullptr;
+    uint64_t version = 0;
+    if (!OptimisticFindLeaf(key, rawLeaf, version)) {
+      continue;
+    }
+    if (rawLeaf == nullptr) {
+      result.clear();
+      return false;
+    }
+    auto *leaf =
+        reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(rawLeaf->GetData());
+    ValueType value;
+    bool found = leaf->GetSize() <= leaf->GetMaxSize() + 1 &&
+                 leaf->Lookup(key, value, comparator_);
+    bool valid = rawLeaf->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(rawLeaf->GetPageId(), false);
+    if (!valid) {
+      continue;
+    }
+    result.clear();
+    if (found) {
+      result.push_back(value);
+    }
+    return found;
+  }
+
   auto *leaf = FindLeafPage(key, root_page_id_, transaction, SEARCH);
   if (leaf == nullptr) {
     return false;
@@ -105,6 +134,12 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key,
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value,
                             Transaction *transaction) {
+  // every writer latches the pages it changes, or optimistic lookups could
+  // validate a page in the middle of a change
+  Transaction local_transaction(INVALID_TXN_ID);
+  if (transaction == nullptr) {
+    transaction = &local_transaction;
+  }
   {
     std::lock_guard<std::mutex> lock(mutex_);
     if (IsEmpty()) {
@@ -130,14 +165,16 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
     throw std::bad_alloc();
   }
 
-  root_page_id_ = id;
-
-  UpdateRootPageId(true);
-
   auto *lp =
         reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
+  page->WLatch();
   lp->Init(id, INVALID_PAGE_ID);
   lp->Insert(key, value, comparator_); 
+  page->WUnlatch();
+
+  // published once it holds the key
+  root_page_id_ = id;
+  UpdateRootPageId(true);
 }
 
 /*
@@ -215,8 +252,10 @@ template <typename N> N *BPLUSTREE_TYPE::Split(N *node) {
   auto *BTreePage =
         reinterpret_cast<N *>(page->GetData());
   // Init method after creating a new leaf page
+  page->WLatch();
   BTreePage->Init(id, node->GetParentPageId());
   node->MoveHalfTo(BTreePage, buffer_pool_manager_); 
+  page->WUnlatch();
   return BTreePage;
 }
 
@@ -244,18 +283,21 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node,
       throw std::bad_alloc();
     }
     auto ip = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(newPage->GetData());
+    newPage->WLatch();
     ip->Init(parentPageId, INVALID_PAGE_ID);
 
-    root_page_id_ = parentPageId; // set root is the new created parent page
-
-    UpdateRootPageId(false);
-
     // assign old and new nodes parent
     old_node->SetParentPageId(parentPageId);
     new_node->SetParentPageId(parentPageId);
 
     // Note: important APi for new root to add 2 nodes
     ip->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    newPage->WUnlatch();
+
+    // set root is the new created parent page, only now that lookups can
+    // find both children through it
+    root_page_id_ = parentPageId;
+    UpdateRootPageId(false);
 
     buffer_pool_manager_->UnpinPage(parentPageId, true);
   } else {
@@ -294,6 +336,11 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   if (IsEmpty()) {
     return;
   }
+  // latched like Insert
+  Transaction local_transaction(INVALID_TXN_ID);
+  if (transaction == nullptr) {
+    transaction = &local_transaction;
+  }
 
   auto *leaf = FindLeafPage(key, root_page_id_, transaction, DELETE);
   if (leaf == nullptr) {
@@ -365,13 +412,17 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
     auto *sibling = reinterpret_cast<decltype(node)>(siblingRawPage->GetData());
     assert(sibling);
     isLeftSibling = true;
+    // siblings are off the latched path, latch them like it
+    siblingRawPage->WLatch();
 
     if (sibling->GetSize() + node->GetSize() > node->GetMaxSize()) {
       Redistribute(sibling, node, index);
+      siblingRawPage->WUnlatch();
       buffer_pool_manager_->UnpinPage(v, false); 
       return false;
     }
     // unpin
+    siblingRawPage->WUnlatch();
     buffer_pool_manager_->UnpinPage(v, false); 
   } 
   
@@ -381,13 +432,16 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
     auto *siblingRawPage = buffer_pool_manager_->FetchPage(v);
     auto *sibling = reinterpret_cast<decltype(node)>(siblingRawPage->GetData());
     isRightSibling = true;
+    siblingRawPage->WLatch();
 
     if (sibling->GetSize() + node->GetSize() > node->GetMaxSize()) {
       Redistribute(sibling, node, 0); // Right sibling set 'index" to 0
+      siblingRawPage->WUnlatch();
       buffer_pool_manager_->UnpinPage(v, false);
       return false;
     }
     // unpin
+    siblingRawPage->WUnlatch();
     buffer_pool_manager_->UnpinPage(v, false); 
   }
 
@@ -406,6 +460,7 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
 
   auto *siblingRawPage = buffer_pool_manager_->FetchPage(v);
   auto *sibling = reinterpret_cast<decltype(node)>(siblingRawPage->GetData());
+  siblingRawPage->WLatch();
 
   if (isLeftSibling) {
     // Move us to sibling, pass in our inde in parent
@@ -416,6 +471,7 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
   }
 
   // unpin
+  siblingRawPage->WUnlatch();
   buffer_pool_manager_->UnpinPage(v, false);  
 
   // node needs coalesce. Leaf node needs to be deleted. So we mark as true.
@@ -589,6 +645,31 @@ B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, pag
     return nullptr;
   }
 
+  // a latched point lookup only needs the latch on the leaf, the internal
+  // pages above it are read optimistically
+  if (op == SEARCH && transaction != nullptr && !leftMost &&
+      root_id == root_page_id_) {
+    for (int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES; ++attempt) {
+      Page *rawLeaf = nullptr;
+      uint64_t version = 0;
+      if (!OptimisticFindLeaf(key, rawLeaf, version)) {
+        continue;
+      }
+      if (rawLeaf == nullptr) {
+        return nullptr;
+      }
+      rawLeaf->RLatch();
+      // unchanged since the descent, so it is still the leaf of key
+      if (rawLeaf->ValidateVersion(version)) {
+        transaction->AddIntoPageSet(rawLeaf);
+        return reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(
+            rawLeaf->GetData());
+      }
+      rawLeaf->RUnlatch();
+      buffer_pool_manager_->UnpinPage(rawLeaf->GetPageId(), false);
+    }
+  }
+
   page_id_t page_id = root_id;                                                       
   auto *rawPage = buffer_pool_manager_->FetchPage(page_id);
   BPlusTreePage *page =
@@ -604,6 +685,7 @@ B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, pag
   }
 
   while (page != nullptr && !page->IsLeafPage()) {
+    KeepResident(rawPage);
     // cast to internal page
     auto *internalPage =
         reinterpret_cast<BPlusTreeInternalPage<KeyType,page_id_t,KeyComparator> *>(rawPage->GetData());
@@ -659,6 +741,90 @@ B_PLUS_TREE_LEAF_PAGE_TYPE *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, pag
   return reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page);
 }
 
+/*
+ * Internal pages, the root among them, are on the path of every lookup below
+ * them: have the buffer pool evict them only after the leaves. The priority
+ * sticks to the page id, so this calls into the pool once per page, not once
+ * per visit
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::KeepResident(Page *page) {
+  if (page->GetPriority() != PagePriority::HIGH) {
+    buffer_pool_manager_->SetPagePriority(page->GetPageId(),
+                                          PagePriority::HIGH);
+  }
+}
+
+/*
+ * Walk from the root to the leaf that may contain key without latching any
+ * page. Each internal page is validated once the child id has been read from
+ * it, and again after the version of the child is snapshotted, so the child
+ * was really its child at that point. The root is checked the same way
+ * against root_page_id_. On success the leaf is returned pinned together with
+ * its version snapshot, which the caller validates after reading it; leaf is
+ * nullptr for an empty tree. Returns false, with nothing pinned, when a writer
+ * got in the way.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::OptimisticFindLeaf(const KeyType &key, Page *&leaf,
+                                        uint64_t &version) {
+  page_id_t page_id = root_page_id_;
+  leaf = nullptr;
+  if (page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  Page *rawPage = buffer_pool_manager_->FetchPage(page_id);
+  if (rawPage == nullptr) {
+    return false;
+  }
+  version = rawPage->ReadVersion();
+  if (page_id != root_page_id_) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return false;
+  }
+
+  while (true) {
+    auto *page = reinterpret_cast<BPlusTreePage *>(rawPage->GetData());
+    bool isLeaf = page->IsLeafPage();
+    page_id_t childId = INVALID_PAGE_ID;
+    if (!isLeaf) {
+      auto *internalPage = reinterpret_cast<
+          BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(page);
+      // a torn read may see any size, do not search past the page
+      int size = internalPage->GetSize();
+      if (size > 0 && size <= internalPage->GetMaxSize() + 1) {
+        childId = internalPage->Lookup(key, comparator_);
+      }
+    }
+    if (!rawPage->ValidateVersion(version) ||
+        (!isLeaf && childId == INVALID_PAGE_ID)) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      return false;
+    }
+    if (isLeaf) {
+      leaf = rawPage;
+      return true;
+    }
+    KeepResident(rawPage);
+
+    Page *child = buffer_pool_manager_->FetchPage(childId);
+    if (child == nullptr) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      return false;
+    }
+    uint64_t childVersion = child->ReadVersion();
+    bool valid = rawPage->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (!valid) {
+      buffer_pool_manager_->UnpinPage(childId, false);
+      return false;
+    }
+    rawPage = child;
+    page_id = childId;
+    version = childVersion;
+  }
+}
+
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
@@ -0,0 +1,342 @@
+/**
+ * extendible_hash_table.cpp
+ */
+#include <new>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/rid.h"
+#include "index/extendible_hash_table.h"
+#include "page/header_page.h"
+
+namespace cmudb {
+
+namespace {
+// MurmurHash3's 64 bit finalizer, every output bit depends on every input bit
+inline uint64_t Mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+} // namespace
+
+/*
+ * Constructor: a new table gets its header page now and is recorded in the
+ * database header page, like the root of a b+ tree
+ */
+INDEX_TEMPLATE_ARGUMENTS
+HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name,
+                                     BufferPoolManager *buffer_pool_manager,
+                                     const KeyComparator &comparator,
+                                     page_id_t header_page_id)
+    : index_name_(name), header_page_id_(header_page_id),
+      buffer_pool_manager_(buffer_pool_manager), comparator_(comparator) {
+  if (header_page_id_ != INVALID_PAGE_ID) {
+    return;
+  }
+  WritePageGuard header_guard =
+      buffer_pool_manager_->NewPageGuarded(header_page_id_);
+  if (!header_guard) {
+    LOG_INFO("ExtendibleHashTable failed due to buffer pool manager out of "
+             "memory!");
+    throw std::bad_alloc();
+  }
+  header_guard.AsMut<HashTableHeaderPage>()->Init(header_page_id_);
+  KeepResident(header_guard.GetPage());
+
+  HeaderPage *header_page = static_cast<HeaderPage *>(
+      buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  if (header_page == nullptr) {
+    LOG_INFO("ExtendibleHashTable failed due to buffer pool manager out of "
+             "memory!");
+    throw std::bad_alloc();
+  }
+  header_page->InsertRecord(index_name_, header_page_id_);
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+/*
+ * Hash of the key as the comparator sees it: keys with different bytes may
+ * still be equal, like a DECIMAL 0.0 and -0.0, and must land in the same
+ * bucket
+ */
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t HASH_TABLE_TYPE::Hash(const KeyType &key) const {
+  return static_cast<uint32_t>(Mix(comparator_.Hash(key)));
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * Return the only value that associated with input key
+ * This method is used for point query
+ * @return : true means key exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::GetValue(const KeyType &key,
+                               std::vector<ValueType> &result,
+                               Transaction *transaction) {
+  uint32_t hash = Hash(key);
+  page_id_t directory_page_id = GetDirectoryPageId(hash, false);
+  if (directory_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  ReadPageGuard directory_guard = LatchRead(directory_page_id);
+  auto *directory = directory_guard.As<HashTableDirectoryPage>();
+  ReadPageGuard bucket_guard = LatchRead(
+      directory->GetBucketPageId(directory->HashToBucketIndex(hash)));
+  // the bucket is latched, splitting it needs its latch
+  directory_guard.Release();
+
+  ValueType value;
+  if (!bucket_guard.As<HASH_TABLE_BUCKET_PAGE_TYPE>()->Lookup(key, value,
+                                                              comparator_)) {
+    return false;
+  }
+  result.push_back(value);
+  return true;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert constant key & value pair into the bucket of its hash. Mostly the
+ * bucket has room, which the directory read latched is enough for. A full
+ * one is split with the directory write latched, as often as it takes for
+ * the bucket of the key to have room. A bucket that is full at the maximum
+ * depth throws, the table cannot take the key.
+ * @return: since we only support unique key, if user try to insert duplicate
+ * keys return false, otherwise return true.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::Insert(const KeyType &key, const ValueType &value,
+                             Transaction *transaction) {
+  uint32_t hash = Hash(key);
+  page_id_t directory_page_id = GetDirectoryPageId(hash, true);
+  {
+    ReadPageGuard directory_guard = LatchRead(directory_page_id);
+    auto *directory = directory_guard.As<HashTableDirectoryPage>();
+    WritePageGuard bucket_guard = LatchWrite(
+        directory->GetBucketPageId(directory->HashToBucketIndex(hash)));
+    auto *bucket = bucket_guard.As<HASH_TABLE_BUCKET_PAGE_TYPE>();
+    ValueType existing;
+    if (bucket->Lookup(key, existing, comparator_)) {
+      return false;
+    }
+    if (!bucket->IsFull()) {
+      return bucket_guard.AsMut<HASH_TABLE_BUCKET_PAGE_TYPE>()->Insert(
+          key, value, comparator_);
+    }
+  }
+
+  WritePageGuard directory_guard = LatchWrite(directory_page_id);
+  for (;;) {
+    auto *directory = directory_guard.As<HashTableDirectoryPage>();
+    uint32_t bucket_idx = directory->HashToBucketIndex(hash);
+    WritePageGuard bucket_guard =
+        LatchWrite(directory->GetBucketPageId(bucket_idx));
+    auto *bucket = bucket_guard.As<HASH_TABLE_BUCKET_PAGE_TYPE>();
+    ValueType existing;
+    if (bucket->Lookup(key, existing, comparator_)) {
+      return false;
+    }
+    if (!bucket->IsFull()) {
+      return bucket_guard.AsMut<HASH_TABLE_BUCKET_PAGE_TYPE>()->Insert(
+          key, value, comparator_);
+    }
+    if (!SplitBucket(directory_guard, bucket_guard, bucket_idx)) {
+      throw Exception(EXCEPTION_TYPE_INDEX,
+                      "hash bucket is full and at the maximum depth");
+    }
+  }
+}
+
+/*
+ * Split the full bucket in slot bucket_idx by one more bit of the hash: the
+ * keys with that bit set move to a new bucket, and so do the directory slots
+ * with that bit set that pointed to the old one. The directory doubles first
+ * if the bucket was in a single slot
+ * @return: false if the directory is at its maximum depth already
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::SplitBucket(WritePageGuard &directory_guard,
+                                  WritePageGuard &bucket_guard,
+                                  uint32_t bucket_idx) {
+  auto *directory = directory_guard.AsMut<HashTableDirectoryPage>();
+  uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+  if (local_depth == directory->GetGlobalDepth()) {
+    if (directory->GetGlobalDepth() == directory->GetMaxDepth()) {
+      return false;
+    }
+    directory->IncrGlobalDepth();
+  }
+
+  page_id_t new_page_id;
+  WritePageGuard new_guard =
+      buffer_pool_manager_->NewPageGuarded(new_page_id);
+  if (!new_guard) {
+    LOG_INFO("SplitBucket failed due to buffer pool manager out of memory!");
+    throw std::bad_alloc();
+  }
+  auto *new_bucket = new_guard.AsMut<HASH_TABLE_BUCKET_PAGE_TYPE>();
+  new_bucket->Init(new_page_id);
+
+  page_id_t old_page_id = bucket_guard.GetPageId();
+  uint32_t split_bit = 1u << local_depth;
+  for (uint32_t i = 0; i < directory->Size(); i++) {
+    if (directory->GetBucketPageId(i) == old_page_id) {
+      directory->SetLocalDepth(i, local_depth + 1);
+      if (i & split_bit) {
+        directory->SetBucketPageId(i, new_page_id);
+      }
+    }
+  }
+
+  auto *bucket = bucket_guard.AsMut<HASH_TABLE_BUCKET_PAGE_TYPE>();
+  for (int i = 0; i < bucket->GetSize();) {
+    if (Hash(bucket->KeyAt(i)) & split_bit) {
+      new_bucket->Insert(bucket->KeyAt(i), bucket->ValueAt(i), comparator_);
+      bucket->RemoveAt(i);
+    } else {
+      i++;
+    }
+  }
+  return true;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Delete key & value pair associated with input key. An emptied bucket stays
+ * where it is
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  uint32_t hash = Hash(key);
+  page_id_t directory_page_id = GetDirectoryPageId(hash, false);
+  if (directory_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  ReadPageGuard directory_guard = LatchRead(directory_page_id);
+  auto *directory = directory_guard.As<HashTableDirectoryPage>();
+  WritePageGuard bucket_guard = LatchWrite(
+      directory->GetBucketPageId(directory->HashToBucketIndex(hash)));
+  directory_guard.Release();
+
+  auto *bucket = bucket_guard.As<HASH_TABLE_BUCKET_PAGE_TYPE>();
+  ValueType existing;
+  if (bucket->Lookup(key, existing, comparator_)) {
+    bucket_guard.AsMut<HASH_TABLE_BUCKET_PAGE_TYPE>()->Remove(key,
+                                                              comparator_);
+  }
+}
+
+/*****************************************************************************
+ * UTILITIES AND DEBUG
+ *****************************************************************************/
+/*
+ * Page id of the directory of a hash. A directory is only made, with one
+ * empty bucket, by the first insert that needs it (create), and stays where
+ * it is from then on
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t HASH_TABLE_TYPE::GetDirectoryPageId(uint32_t hash, bool create) {
+  {
+    ReadPageGuard header_guard = LatchRead(header_page_id_);
+    KeepResident(header_guard.GetPage());
+    auto *header = header_guard.As<HashTableHeaderPage>();
+    page_id_t directory_page_id =
+        header->GetDirectoryPageId(header->HashToDirectoryIndex(hash));
+    if (directory_page_id != INVALID_PAGE_ID || !create) {
+      return directory_page_id;
+    }
+  }
+
+  // another insert may have made it in the meantime
+  WritePageGuard header_guard = LatchWrite(header_page_id_);
+  auto *header = header_guard.As<HashTableHeaderPage>();
+  uint32_t directory_idx = header->HashToDirectoryIndex(hash);
+  page_id_t directory_page_id = header->GetDirectoryPageId(directory_idx);
+  if (directory_page_id != INVALID_PAGE_ID) {
+    return directory_page_id;
+  }
+
+  page_id_t bucket_page_id;
+  WritePageGuard bucket_guard =
+      buffer_pool_manager_->NewPageGuarded(bucket_page_id);
+  WritePageGuard directory_guard =
+      buffer_pool_manager_->NewPageGuarded(directory_page_id);
+  if (!bucket_guard || !directory_guard) {
+    LOG_INFO("GetDirectoryPageId failed due to buffer pool manager out of "
+             "memory!");
+    throw std::bad_alloc();
+  }
+  bucket_guard.AsMut<HASH_TABLE_BUCKET_PAGE_TYPE>()->Init(bucket_page_id);
+  directory_guard.AsMut<HashTableDirectoryPage>()->Init(directory_page_id,
+                                                        bucket_page_id);
+  KeepResident(directory_guard.GetPage());
+  header_guard.AsMut<HashTableHeaderPage>()->SetDirectoryPageId(
+      directory_idx, directory_page_id);
+  return directory_page_id;
+}
+
+/*
+ * Latch an existing page of the table, throw if the pool has no frame left
+ * for it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ReadPageGuard HASH_TABLE_TYPE::LatchRead(page_id_t page_id) {
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id);
+  if (!guard) {
+    LOG_INFO("ExtendibleHashTable failed due to buffer pool manager out of "
+             "memory!");
+    throw std::bad_alloc();
+  }
+  return guard;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+WritePageGuard HASH_TABLE_TYPE::LatchWrite(page_id_t page_id) {
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(page_id);
+  if (!guard) {
+    LOG_INFO("ExtendibleHashTable failed due to buffer pool manager out of "
+             "memory!");
+    throw std::bad_alloc();
+  }
+  return guard;
+}
+
+/*
+ * Header and directory pages are on the path of every operation
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::KeepResident(Page *page) {
+  if (page->GetPriority() != PagePriority::HIGH) {
+    buffer_pool_manager_->SetPagePriority(page->GetPageId(),
+                                          PagePriority::HIGH);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int HASH_TABLE_TYPE::GetGlobalDepth(uint32_t hash) {
+  page_id_t directory_page_id = GetDirectoryPageId(hash, false);
+  if (directory_page_id == INVALID_PAGE_ID) {
+    return -1;
+  }
+  ReadPageGuard directory_guard = LatchRead(directory_page_id);
+  return directory_guard.As<HashTableDirectoryPage>()->GetGlobalDepth();
+}
+
+template class ExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+
+} // namespace cmudb
@@ -14,7 +14,10 @@ namespace cmudb {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator(BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf,
               int index_, BufferPoolManager *buff_pool_manager):
-    leaf_(leaf), index_(index_), buff_pool_manager_(buff_pool_manager) {}
+    leaf_(leaf), index_(index_), buff_pool_manager_(buff_pool_manager),
+    strategy_(std::make_shared<BufferAccessStrategy>()) {
+  buff_pool_manager_->PrefetchPage(leaf_->GetNextPageId(), strategy_);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() {
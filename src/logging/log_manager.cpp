@@ -16,34 +16,53 @@ void LogManager::SwapBuffer() {
 }
 
 void LogManager::wakeUpFlushThread() {
-  if (log_buf_offset_ > 0) {
+  std::lock_guard<std::mutex> lock(latch_);
+  RequestFlush();
+}
+
+/*
+ * Hand the log buffer to the flush thread, unless it is empty or the flush
+ * thread still has the previous one. Caller must hold latch_
+ */
+void LogManager::RequestFlush() {
+  if (log_buf_offset_ > 0 && flush_size_ == 0) {
     SwapBuffer();
     // wake up flush thread
     cv_.notify_one();
-  }  
+  }
+}
+
+/*
+ * Block until the log is persistent up to lsn, e.g. before the buffer pool
+ * writes a page with that LSN (WAL). The flush thread is asked for an early
+ * flush and we sleep until it wrote something, no polling. Returns at once
+ * while logging is off, there is no flush thread then
+ */
+void LogManager::WaitForPersistentLSN(lsn_t lsn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (ENABLE_LOGGING && lsn > persistent_lsn_) {
+    RequestFlush();
+    flushed_cv_.wait_for(lock, LOG_TIMEOUT);
+  }
 }
 
+/*
+ * Body of the flush thread: write the flush buffer when woken up, and the
+ * log buffer every LOG_TIMEOUT
+ */
 void LogManager::task1() {
-  
+  std::unique_lock<std::mutex> lk(latch_);
   while (ENABLE_LOGGING) {
-      std::cout << "Thread another loop\n";
-      std::unique_lock<std::mutex> lk(latch_);
-      auto now = std::chrono::system_clock::now();
-      if(cv_.wait_until(lk, now + LOG_TIMEOUT, [&](){ return false; })) {
-        // buffer full or buffer manager signal
-        std::cout << "Thread was wakenup to write log\n";
-        disk_manager_->WriteLog(flush_buffer_, flush_size_);
-        flush_size_ = 0; 
-      }
-      else {
-        // time out, flush
-        if (log_buf_offset_ > 0) {
-          SwapBuffer();
-          std::cout << "Thread timed out. log size is: " << flush_size_ << std::endl;
-          disk_manager_->WriteLog(flush_buffer_, flush_size_);
-          flush_size_ = 0;
-        }                
-      }          
+    cv_.wait_for(lk, LOG_TIMEOUT);
+    if (flush_size_ == 0) {
+      // time out, flush
+      RequestFlush();
+    }
+    if (flush_size_ > 0) {
+      disk_manager_->WriteLog(flush_buffer_, flush_size_);
+      flush_size_ = 0;
+    }
+    flushed_cv_.notify_all();
   }
 }
 
@@ -64,9 +83,15 @@ void LogManager::RunFlushThread() {
  * Stop and join the flush thread, set ENABLE_LOGGING = false
  */
 void LogManager::StopFlushThread() {
-
-  ENABLE_LOGGING = false;
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    ENABLE_LOGGING = false;
+    cv_.notify_one();
+    flushed_cv_.notify_all();
+  }
   flush_thread_->join();
+  delete flush_thread_;
+  flush_thread_ = nullptr;
 }
 
 /*
@@ -92,7 +117,8 @@ void LogManager::StopFlushThread() {
 lsn_t LogManager::AppendLogRecord(LogRecord &log_record) {
   std::lock_guard<std::mutex> lock(latch_);
 
-  if (log_buf_offset_ + log_record.size_ >= LOG_BUFFER_SIZE) {
+  if (log_buf_offset_ + log_record.size_ >=
+      static_cast<size_t>(LOG_BUFFER_SIZE)) {
     SwapBuffer();
     // wake up flush thread
     cv_.notify_one();
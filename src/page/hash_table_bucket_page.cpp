@@ -0,0 +1,94 @@
+/**
+ * hash_table_bucket_page.cpp
+ */
+
+#include "common/rid.h"
+#include "page/hash_table_bucket_page.h"
+
+namespace cmudb {
+
+/*
+ * Init method after creating a new bucket page: empty, with as many entries
+ * as fit into the page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_BUCKET_PAGE_TYPE::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  size_ = 0;
+  max_size_ =
+      (PAGE_SIZE - sizeof(HASH_TABLE_BUCKET_PAGE_TYPE)) / sizeof(MappingType);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType HASH_TABLE_BUCKET_PAGE_TYPE::KeyAt(int index) const {
+  return array_[index].first;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+ValueType HASH_TABLE_BUCKET_PAGE_TYPE::ValueAt(int index) const {
+  return array_[index].second;
+}
+
+/*
+ * Index of the entry with key, -1 if there is none
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int HASH_TABLE_BUCKET_PAGE_TYPE::KeyIndex(
+    const KeyType &key, const KeyComparator &comparator) const {
+  for (int i = 0; i < size_; i++) {
+    if (comparator(array_[i].first, key) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_BUCKET_PAGE_TYPE::Lookup(
+    const KeyType &key, ValueType &value,
+    const KeyComparator &comparator) const {
+  int index = KeyIndex(key, comparator);
+  if (index < 0) {
+    return false;
+  }
+  value = array_[index].second;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_BUCKET_PAGE_TYPE::Insert(const KeyType &key,
+                                         const ValueType &value,
+                                         const KeyComparator &comparator) {
+  if (IsFull() || KeyIndex(key, comparator) >= 0) {
+    return false;
+  }
+  array_[size_] = MappingType(key, value);
+  size_++;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_BUCKET_PAGE_TYPE::Remove(const KeyType &key,
+                                         const KeyComparator &comparator) {
+  int index = KeyIndex(key, comparator);
+  if (index < 0) {
+    return false;
+  }
+  RemoveAt(index);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_BUCKET_PAGE_TYPE::RemoveAt(int index) {
+  size_--;
+  array_[index] = array_[size_];
+}
+
+template class HashTableBucketPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class HashTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class HashTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+} // namespace cmudb
@@ -0,0 +1,70 @@
+/**
+ * hash_table_directory_page.cpp
+ */
+#include <cassert>
+
+#include "page/hash_table_directory_page.h"
+
+namespace cmudb {
+
+/*
+ * Init method after creating a new directory page: the deepest arrays that
+ * fit into the page, global depth 0 with its only slot pointing to
+ * bucket_page_id
+ */
+void HashTableDirectoryPage::Init(page_id_t page_id,
+                                  page_id_t bucket_page_id) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  global_depth_ = 0;
+  max_depth_ = 0;
+  for (;;) {
+    max_depth_++;
+    size_t size = sizeof(HashTableDirectoryPage) + LocalDepthsSize() +
+                  sizeof(page_id_t) * (static_cast<size_t>(1) << max_depth_);
+    if (size > static_cast<size_t>(PAGE_SIZE)) {
+      max_depth_--;
+      break;
+    }
+  }
+  SetLocalDepth(0, 0);
+  SetBucketPageId(0, bucket_page_id);
+}
+
+uint32_t HashTableDirectoryPage::HashToBucketIndex(uint32_t hash) const {
+  return hash & (Size() - 1);
+}
+
+page_id_t HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) const {
+  return BucketPageIds()[bucket_idx];
+}
+
+void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx,
+                                             page_id_t bucket_page_id) {
+  BucketPageIds()[bucket_idx] = bucket_page_id;
+}
+
+uint32_t HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) const {
+  return LocalDepths()[bucket_idx];
+}
+
+void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx,
+                                           uint32_t local_depth) {
+  LocalDepths()[bucket_idx] = static_cast<uint8_t>(local_depth);
+}
+
+/*
+ * Slot i + 2^GlobalDepth has the same bottom GlobalDepth bits as slot i, so
+ * it starts out with the same bucket
+ */
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  assert(global_depth_ < max_depth_);
+  uint32_t size = Size();
+  for (uint32_t i = 0; i < size; i++) {
+    SetLocalDepth(i + size, GetLocalDepth(i));
+    SetBucketPageId(i + size, GetBucketPageId(i));
+  }
+  global_depth_++;
+}
+
+} // namespace cmudb
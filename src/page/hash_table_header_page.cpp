@@ -0,0 +1,46 @@
+/**
+ * hash_table_header_page.cpp
+ */
+#include "page/hash_table_header_page.h"
+
+namespace cmudb {
+
+/*
+ * Init method after creating a new header page: the deepest directory array
+ * that fits into the page, every slot without a directory yet
+ */
+void HashTableHeaderPage::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  max_depth_ = 0;
+  while (sizeof(HashTableHeaderPage) +
+             sizeof(page_id_t) * (static_cast<size_t>(2) << max_depth_) <=
+         static_cast<size_t>(PAGE_SIZE)) {
+    max_depth_++;
+  }
+  for (uint32_t i = 0; i < MaxSize(); i++) {
+    directory_page_ids_[i] = INVALID_PAGE_ID;
+  }
+}
+
+/*
+ * The top bits, directory pages index their buckets by the bottom ones
+ */
+uint32_t HashTableHeaderPage::HashToDirectoryIndex(uint32_t hash) const {
+  if (max_depth_ == 0) {
+    return 0;
+  }
+  return hash >> (32 - max_depth_);
+}
+
+page_id_t
+HashTableHeaderPage::GetDirectoryPageId(uint32_t directory_idx) const {
+  return directory_page_ids_[directory_idx];
+}
+
+void HashTableHeaderPage::SetDirectoryPageId(uint32_t directory_idx,
+                                             page_id_t directory_page_id) {
+  directory_page_ids_[directory_idx] = directory_page_id;
+}
+
+} // namespace cmudb
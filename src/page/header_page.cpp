@@ -8,6 +8,9 @@
 
 namespace cmudb {
 
+#define RECORDS_OFFSET HEADER_PAGE_RECORDS_OFFSET
+#define RECORD_SIZE 36
+
 /**
  * Record related
  */
@@ -17,9 +20,9 @@ bool HeaderPage::InsertRecord(const std::string &name,
   assert(root_id > INVALID_PAGE_ID);
 
   int record_num = GetRecordCount();
-  int offset = 4 + record_num * 36;
-  // check for duplicate name
-  if (FindRecord(name) != -1)
+  int offset = RECORDS_OFFSET + record_num * RECORD_SIZE;
+  // check for duplicate name, and for room on the page
+  if (FindRecord(name) != -1 || offset + RECORD_SIZE > PAGE_SIZE)
     return false;
   // copy record content
   memcpy(GetData() + offset, name.c_str(), (name.length() + 1));
@@ -37,9 +40,9 @@ bool HeaderPage::DeleteRecord(const std::string &name) {
   // record does not exsit
   if (index == -1)
     return false;
-  int offset = index * 36 + 4;
-  memmove(GetData() + offset, GetData() + offset + 36,
-          (record_num - index - 1) * 36);
+  int offset = RECORDS_OFFSET + index * RECORD_SIZE;
+  memmove(GetData() + offset, GetData() + offset + RECORD_SIZE,
+          (record_num - index - 1) * RECORD_SIZE);
 
   SetRecordCount(record_num - 1);
   return true;
@@ -53,7 +56,7 @@ bool HeaderPage::UpdateRecord(const std::string &name,
   // record does not exsit
   if (index == -1)
     return false;
-  int offset = index * 36 + 4;
+  int offset = RECORDS_OFFSET + index * RECORD_SIZE;
   // update record content, only root_id
   memcpy((GetData() + offset + 32), &root_id, 4);
 
@@ -67,7 +70,7 @@ bool HeaderPage::GetRootId(const std::string &name, page_id_t &root_id) {
   // record does not exsit
   if (index == -1)
     return false;
-  int offset = (index + 1) * 36;
+  int offset = RECORDS_OFFSET + index * RECORD_SIZE + 32;
   root_id = *reinterpret_cast<page_id_t *>(GetData() + offset);
 
   return true;
@@ -83,11 +86,36 @@ void HeaderPage::SetRecordCount(int record_count) {
   memcpy(GetData(), &record_count, 4);
 }
 
+// page size of the database file
+int HeaderPage::GetPageSize() {
+  return *reinterpret_cast<int *>(GetData() + HEADER_PAGE_SIZE_OFFSET);
+}
+
+void HeaderPage::SetPageSize(int page_size) {
+  memcpy(GetData() + HEADER_PAGE_SIZE_OFFSET, &page_size, 4);
+}
+
+// format of the header page
+bool HeaderPage::IsCurrentFormat() {
+  return *reinterpret_cast<int *>(GetData() + HEADER_PAGE_MAGIC_OFFSET) ==
+             HEADER_PAGE_MAGIC &&
+         *reinterpret_cast<int *>(GetData() + HEADER_PAGE_VERSION_OFFSET) ==
+             HEADER_PAGE_VERSION;
+}
+
+void HeaderPage::SetFormat() {
+  int magic = HEADER_PAGE_MAGIC;
+  int version = HEADER_PAGE_VERSION;
+  memcpy(GetData() + HEADER_PAGE_MAGIC_OFFSET, &magic, 4);
+  memcpy(GetData() + HEADER_PAGE_VERSION_OFFSET, &version, 4);
+}
+
 int HeaderPage::FindRecord(const std::string &name) {
   int record_num = GetRecordCount();
 
   for (int i = 0; i < record_num; i++) {
-    char *raw_name = reinterpret_cast<char *>(GetData() + (4 + i * 36));
+    char *raw_name =
+        reinterpret_cast<char *>(GetData() + RECORDS_OFFSET + i * RECORD_SIZE);
     if (strcmp(raw_name, name.c_str()) == 0)
       return i;
   }
@@ -3,6 +3,7 @@
  */
 
 #include <cassert>
+#include <utility>
 
 #include "common/logger.h"
 #include "table/table_heap.h"
@@ -22,15 +23,12 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager,
                      Transaction *txn)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager),
       log_manager_(log_manager) {
-  auto first_page =
-      static_cast<TablePage *>(buffer_pool_manager_->NewPage(first_page_id_));
-  assert(first_page != nullptr); // todo: abort table creation?
-  first_page->WLatch();
+  WritePageGuard guard = buffer_pool_manager_->NewPageGuarded(first_page_id_);
+  assert(guard); // todo: abort table creation?
+  auto first_page = static_cast<TablePage *>(guard.GetPage());
   LOG_DEBUG("new table page created %d", first_page_id_);
 
   first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
-  first_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
@@ -39,119 +37,122 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
     return false;
   }
 
-  auto cur_page =
-      static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(first_page_id_);
+  if (!guard) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  cur_page->WLatch();
+  auto cur_page = static_cast<TablePage *>(guard.GetPage());
   while (!cur_page->InsertTuple(
       tuple, rid, txn, lock_manager_,
       log_manager_)) { // fail to insert due to not enough space
     auto next_page_id = cur_page->GetNextPageId();
     if (next_page_id != INVALID_PAGE_ID) { // valid next page
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
-      cur_page = static_cast<TablePage *>(
-          buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
+      guard.Release();
+      guard = buffer_pool_manager_->FetchPageWrite(next_page_id);
+      if (!guard) {
+        txn->SetState(TransactionState::ABORTED);
+        return false;
+      }
+      cur_page = static_cast<TablePage *>(guard.GetPage());
     } else { // create new page
-      auto new_page =
-          static_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id));
-      if (new_page == nullptr) {
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
+      WritePageGuard new_guard =
+          buffer_pool_manager_->NewPageGuarded(next_page_id);
+      if (!new_guard) {
         txn->SetState(TransactionState::ABORTED);
         return false;
       }
-      new_page->WLatch();
-      // std::cout << "new table page " << next_page_id << " created" <<
-      // std::endl;
+      auto new_page = static_cast<TablePage *>(new_guard.GetPage());
       cur_page->SetNextPageId(next_page_id);
+      guard.MarkDirty();
       new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetPageId(),
                      log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
+      guard = std::move(new_guard);
       cur_page = new_page;
     }
   }
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
+  guard.MarkDirty();
+  guard.Release();
   txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
   return true;
 }
 
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // todo: remove empty page
-  auto page = reinterpret_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  if (page == nullptr) {
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!guard) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-  page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  static_cast<TablePage *>(guard.GetPage())
+      ->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  guard.MarkDirty();
+  guard.Release();
   txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
   return true;
 }
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid,
                             Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  if (page == nullptr) {
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!guard) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   Tuple old_tuple;
-  page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, old_tuple, rid, txn, lock_manager_,
-                                      log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_updated);
+  bool is_updated = static_cast<TablePage *>(guard.GetPage())->UpdateTuple(
+      tuple, old_tuple, rid, txn, lock_manager_, log_manager_);
+  if (is_updated) {
+    guard.MarkDirty();
+  }
+  guard.Release();
   if (is_updated && txn->GetState() != TransactionState::ABORTED)
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
   return is_updated;
 }
 
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  assert(page != nullptr);
-  page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  assert(guard);
+  static_cast<TablePage *>(guard.GetPage())
+      ->ApplyDelete(rid, txn, log_manager_);
+  guard.MarkDirty();
   lock_manager_->Unlock(txn, rid);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  assert(page != nullptr);
-  page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  assert(guard);
+  static_cast<TablePage *>(guard.GetPage())
+      ->RollbackDelete(rid, txn, log_manager_);
+  guard.MarkDirty();
 }
 
 // called by tuple iterator
-bool TableHeap::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn) {
-  auto page = static_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  if (page == nullptr) {
+bool TableHeap::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
+                         BufferAccessStrategy *strategy) {
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(
+      rid.GetPageId(),
+      strategy != nullptr ? AccessType::SEQUENTIAL_SCAN : AccessType::RANDOM,
+      strategy);
+  if (!guard) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-  page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
-  return res;
+  return static_cast<TablePage *>(guard.GetPage())
+      ->GetTuple(rid, tuple, txn, lock_manager_);
+}
+
+void TableHeap::PrefetchTuples(const std::vector<RID> &rids) {
+  std::vector<page_id_t> page_ids;
+  for (auto &rid : rids) {
+    // index results are often clustered, skip runs on the same page
+    if (page_ids.empty() || page_ids.back() != rid.GetPageId()) {
+      page_ids.push_back(rid.GetPageId());
+    }
+  }
+  buffer_pool_manager_->PrefetchPages(page_ids);
 }
 
 bool TableHeap::DeleteTableHeap() {
@@ -160,20 +161,28 @@ bool TableHeap::DeleteTableHeap() {
 }
 
 TableIterator TableHeap::begin(Transaction *txn) {
-  auto page =
-      static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  page->RLatch();
-  RID rid;
-  // if failed (no tuple), rid will be the result of default
-  // constructor, which means eof
-  page->GetFirstTupleRid(rid);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(first_page_id_, false);
-  return TableIterator(this, rid, txn);
+  return TableIterator(this, GetFirstTupleRid(), txn);
+}
+
+TableIterator TableHeap::MappedBegin(Transaction *txn) {
+  // only the first page is read through the pool, to find where to start
+  return TableIterator(this, GetFirstTupleRid(), txn,
+                       buffer_pool_manager_->MapDatabaseFile());
 }
 
 TableIterator TableHeap::end() {
   return TableIterator(this, RID(INVALID_PAGE_ID, -1), nullptr);
 }
 
+RID TableHeap::GetFirstTupleRid() {
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(
+      first_page_id_, AccessType::SEQUENTIAL_SCAN);
+  assert(guard);
+  RID rid;
+  // if failed (no tuple), rid will be the result of default
+  // constructor, which means eof
+  static_cast<TablePage *>(guard.GetPage())->GetFirstTupleRid(rid);
+  return rid;
+}
+
 } // namespace cmudb
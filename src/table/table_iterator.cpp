@@ -8,10 +8,15 @@
 
 namespace cmudb {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn,
+                             std::shared_ptr<MappedFile> mapped_file)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn),
+      mapped_file_(std::move(mapped_file)) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
+    strategy_ = std::make_shared<BufferAccessStrategy>();
+    ReadPage(rid.GetPageId(), [this](TablePage *page) {
+      page->GetTuple(tuple_->rid_, *tuple_, txn_, table_heap_->lock_manager_);
+    });
   }
 };
 
@@ -26,34 +31,33 @@ Tuple *TableIterator::operator->() {
 }
 
 TableIterator &TableIterator::operator++() {
-  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(
-      buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  cur_page->RLatch();
-  assert(cur_page != nullptr); // all pages are pinned
-
   RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 next_tuple_rid)) { // end of this page
-    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(
-          buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(next_tuple_rid))
-        break;
+  bool found = false;
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  // a read may run twice, it starts over every time
+  ReadPage(tuple_->rid_.GetPageId(), [&](TablePage *page) {
+    next_tuple_rid = RID();
+    found = page->GetNextTupleRid(tuple_->rid_, next_tuple_rid);
+    next_page_id = page->GetNextPageId();
+  });
+  while (!found && next_page_id != INVALID_PAGE_ID) { // end of this page
+    ReadPage(next_page_id, [&](TablePage *page) {
+      next_tuple_rid = RID();
+      found = page->GetFirstTupleRid(next_tuple_rid);
+      next_page_id = page->GetNextPageId();
+    });
+    // read ahead one page, a mapped scan leaves that to the kernel
+    if (mapped_file_ == nullptr) {
+      table_heap_->buffer_pool_manager_->PrefetchPage(next_page_id, strategy_);
     }
   }
   tuple_->rid_ = next_tuple_rid;
 
   if (*this != table_heap_->end()) {
-    table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
+    ReadPage(tuple_->rid_.GetPageId(), [this](TablePage *page) {
+      page->GetTuple(tuple_->rid_, *tuple_, txn_, table_heap_->lock_manager_);
+    });
   }
-  // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
   return *this;
 }
 
@@ -63,4 +67,33 @@ TableIterator TableIterator::operator++(int) {
   return clone;
 }
 
+/*
+ * Run read on table page page_id. A mapped scan reads the page straight from
+ * the mapping of the database file, unless the pool has the page (its copy
+ * may be newer than the file) or a write of the page to the file overlapped
+ * the read; read then runs once more on the page in the pool. Other scans
+ * read every page through the frames of their ring
+ */
+void TableIterator::ReadPage(page_id_t page_id,
+                             const std::function<void(TablePage *)> &read) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  if (mapped_file_ != nullptr) {
+    Page view;
+    // version before the pool: a cached page written back after the check
+    // fails the validation
+    uint64_t version = mapped_file_->ReadVersion(page_id);
+    if (mapped_file_->View(page_id, view) &&
+        !buffer_pool_manager->IsPageCached(page_id)) {
+      read(static_cast<TablePage *>(&view));
+      if (mapped_file_->ValidateVersion(page_id, version)) {
+        return;
+      }
+    }
+  }
+  ReadPageGuard guard = buffer_pool_manager->FetchPageRead(
+      page_id, AccessType::SEQUENTIAL_SCAN, strategy_.get());
+  assert(guard); // all pages are pinned
+  read(static_cast<TablePage *>(guard.GetPage()));
+}
+
 } // namespace cmudb
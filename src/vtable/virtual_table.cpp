@@ -359,13 +359,35 @@ __declspec(dllexport)
   bool is_file_exist = (stat(db_file_name.c_str(), &buffer) == 0);
 
   // init storage engine
-  storage_engine_ = new StorageEngine(db_file_name);
+  try {
+    storage_engine_ = new StorageEngine(db_file_name);
+  } catch (Exception &e) {
+    *pzErrMsg = sqlite3_mprintf("%s", e.what());
+    return SQLITE_ERROR;
+  }
+  // records of a header page of another format are somewhere else
+  if (is_file_exist) {
+    HeaderPage *header_page = static_cast<HeaderPage *>(
+        storage_engine_->buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+    bool is_current_format = header_page->IsCurrentFormat();
+    storage_engine_->buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, false);
+    if (!is_current_format) {
+      *pzErrMsg = sqlite3_mprintf("%s has no header page of format version %d",
+                                  db_file_name.c_str(), HEADER_PAGE_VERSION);
+      delete storage_engine_;
+      storage_engine_ = nullptr;
+      return SQLITE_ERROR;
+    }
+  }
   // start the logging
   storage_engine_->log_manager_->RunFlushThread();
   // create header page from BufferPoolManager if necessary
   if (!is_file_exist) {
     page_id_t header_page_id;
-    storage_engine_->buffer_pool_manager_->NewPage(header_page_id);
+    HeaderPage *header_page = static_cast<HeaderPage *>(
+        storage_engine_->buffer_pool_manager_->NewPage(header_page_id));
+    // records the page size of the new file
+    header_page->Init();
 
     assert(header_page_id == HEADER_PAGE_ID);
     storage_engine_->buffer_pool_manager_->UnpinPage(header_page_id, true);
@@ -450,6 +472,21 @@ IndexMetadata *ParseIndexStatement(std::string &sql,
   assert(n != std::string::npos);
   index_name = sql.substr(0, n);
   sql = sql.substr(n + 1);
+  // optional index method after the name: "using hash" or "using btree"
+  IndexType index_type = IndexType::BPLUSTREE;
+  StringUtility::Trim(sql);
+  if (sql.compare(0, 6, "using ") == 0) {
+    sql = sql.substr(6);
+    StringUtility::Trim(sql);
+    n = sql.find_first_of(' ');
+    std::string method = sql.substr(0, n);
+    if (method == "hash")
+      index_type = IndexType::HASH;
+    else if (method != "btree")
+      throw Exception(EXCEPTION_TYPE_INDEX,
+                      "can't create index, unknown index method");
+    sql = (n == std::string::npos) ? "" : sql.substr(n + 1);
+  }
 
   std::vector<std::string> tok = StringUtility::Split(sql, ',');
   // iterate through returned result
@@ -463,7 +500,7 @@ IndexMetadata *ParseIndexStatement(std::string &sql,
     throw Exception(EXCEPTION_TYPE_INDEX, "can't create index, format error");
 
   IndexMetadata *metadata =
-      new IndexMetadata(index_name, table_name, schema, key_attrs);
+      new IndexMetadata(index_name, table_name, schema, key_attrs, index_type);
 
   // LOG_DEBUG("%s", metadata->ToString().c_str());
   return metadata;
@@ -505,33 +542,46 @@ Tuple ConstructTuple(Schema *schema, sqlite3_value **argv) {
 }
 
 // serve the functionality of index factory
-Index *ConstructIndex(IndexMetadata *metadata,
-                      BufferPoolManager *buffer_pool_manager,
-                      page_id_t root_id) {
-  // The size of the key in bytes
-  Schema *key_schema = metadata->GetKeySchema();
-  int key_size = key_schema->GetLength();
-  // for each varchar attribute, we assume the largest size is 16 bytes
-  key_size += 16 * key_schema->GetUnlinedColumnCount();
-
+// the index class instantiated for the smallest key that fits key_size
+template <template <typename, typename, typename> class IndexClass>
+static Index *ConstructIndexOfKeySize(int key_size, IndexMetadata *metadata,
+                                      BufferPoolManager *buffer_pool_manager,
+                                      page_id_t root_id) {
   if (key_size <= 4) {
-    return new BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>(
+    return new IndexClass<GenericKey<4>, RID, GenericComparator<4>>(
         metadata, buffer_pool_manager, root_id);
   } else if (key_size <= 8) {
-    return new BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>(
+    return new IndexClass<GenericKey<8>, RID, GenericComparator<8>>(
         metadata, buffer_pool_manager, root_id);
   } else if (key_size <= 16) {
-    return new BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>(
+    return new IndexClass<GenericKey<16>, RID, GenericComparator<16>>(
         metadata, buffer_pool_manager, root_id);
   } else if (key_size <= 32) {
-    return new BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>(
+    return new IndexClass<GenericKey<32>, RID, GenericComparator<32>>(
         metadata, buffer_pool_manager, root_id);
   } else {
-    return new BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>(
+    return new IndexClass<GenericKey<64>, RID, GenericComparator<64>>(
         metadata, buffer_pool_manager, root_id);
   }
 }
 
+Index *ConstructIndex(IndexMetadata *metadata,
+                      BufferPoolManager *buffer_pool_manager,
+                      page_id_t root_id) {
+  // The size of the key in bytes
+  Schema *key_schema = metadata->GetKeySchema();
+  int key_size = key_schema->GetLength();
+  // for each varchar attribute, we assume the largest size is 16 bytes
+  key_size += 16 * key_schema->GetUnlinedColumnCount();
+
+  if (metadata->GetIndexType() == IndexType::HASH) {
+    return ConstructIndexOfKeySize<ExtendibleHashIndex>(
+        key_size, metadata, buffer_pool_manager, root_id);
+  }
+  return ConstructIndexOfKeySize<BPlusTreeIndex>(key_size, metadata,
+                                                 buffer_pool_manager, root_id);
+}
+
 Transaction *GetTransaction() { return global_transaction_; }
 
 } // namespace cmudb
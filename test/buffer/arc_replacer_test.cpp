@@ -0,0 +1,143 @@
+/**
+ * arc_replacer_test.cpp
+ */
+
+#include <cstdio>
+
+#include "buffer/arc_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+// pin, use and unpin value, the way the buffer pool drives the replacer
+static void Touch(ARCReplacer<int> &arc_replacer, int value) {
+  arc_replacer.RecordAccess(value);
+  arc_replacer.Insert(value);
+}
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer<int> arc_replacer(4);
+
+  // 1 and 2 are seen twice (T2), 3 and 4 once (T1)
+  Touch(arc_replacer, 1);
+  Touch(arc_replacer, 2);
+  Touch(arc_replacer, 1);
+  Touch(arc_replacer, 2);
+  Touch(arc_replacer, 3);
+  Touch(arc_replacer, 4);
+  EXPECT_EQ(4, arc_replacer.Size());
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+
+  // T1 is over its target, recency victims go first
+  int value;
+  arc_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+
+  // pinned frames are skipped
+  EXPECT_EQ(true, arc_replacer.Erase(4));
+  arc_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  arc_replacer.Insert(4);
+
+  // 3 comes back from ghost list B1: T1 was too small
+  Touch(arc_replacer, 3);
+  EXPECT_EQ(1, arc_replacer.GetTarget());
+  // T1 now holds just 4 and is at its target, so T2 gives up its oldest
+  arc_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+
+  // 1 comes back from ghost list B2: T2 was too small
+  Touch(arc_replacer, 1);
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+
+  EXPECT_EQ(3, arc_replacer.Size());
+  arc_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+  arc_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  arc_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(false, arc_replacer.Victim(value));
+}
+
+// a removed frame leaves T1/T2 and no ghost, its next page starts over
+TEST(ARCReplacerTest, RemoveTest) {
+  ARCReplacer<int> arc_replacer(4);
+
+  Touch(arc_replacer, 1);
+  Touch(arc_replacer, 2);
+  Touch(arc_replacer, 1);
+  Touch(arc_replacer, 2);
+  Touch(arc_replacer, 3);
+  EXPECT_EQ(3, arc_replacer.Size());
+  arc_replacer.Remove(3);
+  EXPECT_EQ(2, arc_replacer.Size());
+  arc_replacer.Remove(3);
+  EXPECT_EQ(2, arc_replacer.Size());
+
+  // seen once again, not twice: back on T1, and it was no ghost hit
+  Touch(arc_replacer, 3);
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+  int value;
+  arc_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  arc_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  arc_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(false, arc_replacer.Victim(value));
+}
+
+// a victim the pool could not claim goes back as resident, not as a ghost
+TEST(ARCReplacerTest, RestoreTest) {
+  ARCReplacer<int> arc_replacer(4);
+
+  Touch(arc_replacer, 1);
+  Touch(arc_replacer, 1);
+  Touch(arc_replacer, 2);
+  int value;
+  arc_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  arc_replacer.Restore(2);
+  EXPECT_EQ(1, arc_replacer.Size());
+
+  // the unpin of whoever pinned 2 is a resident hit: no adaptation
+  Touch(arc_replacer, 2);
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+  EXPECT_EQ(2, arc_replacer.Size());
+  arc_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  arc_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(false, arc_replacer.Victim(value));
+}
+
+TEST(ARCReplacerTest, ScanResistanceTest) {
+  const int capacity = 10;
+  ARCReplacer<int> arc_replacer(capacity);
+
+  // hot set 0..4 is referenced over and over
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 5; ++i) {
+      Touch(arc_replacer, i);
+    }
+  }
+  // a scan of 100 pages through the other 5 frames, every scan page is
+  // evicted before it is seen again
+  for (int i = 100; i < 200; ++i) {
+    if (arc_replacer.Size() == capacity) {
+      int value;
+      arc_replacer.Victim(value);
+      EXPECT_LE(100, value);
+    }
+    Touch(arc_replacer, i);
+  }
+  // only the scan pages are left on T1
+  for (int i = 0; i < 5; ++i) {
+    int value;
+    arc_replacer.Victim(value);
+    EXPECT_LE(100, value);
+  }
+}
+
+} // namespace cmudb
@@ -2,9 +2,14 @@
  * buffer_pool_manager_test.cpp
  */
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
+#include <thread>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/trace_replayer.h"
 #include "gtest/gtest.h"
 #include "common/logger.h"
 
@@ -50,4 +55,997 @@ TEST(BufferPoolManagerTest, SampleTest) {
   remove("test.db");
 }
 
+// same as the sample test, with the CLOCK replacer picking the victims
+TEST(BufferPoolManagerTest, ClockReplacerTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager, nullptr, ReplacerType::CLOCK);
+
+  auto page_zero = bpm.NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, temp_page_id);
+  strcpy(page_zero->GetData(), "Hello");
+
+  for (int i = 1; i < 10; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  for (int i = 10; i < 15; ++i) {
+    EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  // five unpinned frames: four new pages evict four of them
+  for (int i = 10; i < 14; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  // page zero is either still resident or written back and read again
+  page_zero = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, strcmp(page_zero->GetData(), "Hello"));
+  // the pool is now full of pinned pages
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// with LRU-K a page read once by a scan never evicts a page that is read
+// over and over
+TEST(BufferPoolManagerTest, LRUKScanResistanceTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager, nullptr, ReplacerType::LRU_K, 2);
+
+  // hot pages 0..4 are on disk as "hot"
+  for (int i = 0; i < 5; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    strcpy(page->GetData(), "hot");
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    EXPECT_EQ(true, bpm.FlushPage(temp_page_id));
+  }
+  // a second access each, leaving a change that is only in memory: it is
+  // still there later only if the frame was never evicted
+  for (int i = 0; i < 5; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    strcpy(page->GetData(), "resident");
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  // scan through 50 pages with the remaining 5 frames
+  for (int i = 0; i < 50; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+  for (int i = 0; i < 5; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), "resident"));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// ARC keeps the hot pages while a scan streams through the rest of the pool
+TEST(BufferPoolManagerTest, ARCScanResistanceTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager, nullptr, ReplacerType::ARC);
+
+  for (int i = 0; i < 5; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    strcpy(page->GetData(), "hot");
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    EXPECT_EQ(true, bpm.FlushPage(temp_page_id));
+  }
+  // a change only in memory survives only while the frame is not evicted
+  for (int i = 0; i < 5; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    strcpy(page->GetData(), "resident");
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  for (int i = 0; i < 50; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+  for (int i = 0; i < 5; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), "resident"));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// a scan with a BufferAccessStrategy only recycles the frames of its ring,
+// even with plain LRU the pages of other transactions stay resident
+TEST(BufferPoolManagerTest, ScanRingTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager);
+
+  // pages 0..49 are scanned later
+  for (int i = 0; i < 50; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  // hot pages 50..54 carry a change that is only in memory
+  for (int i = 50; i < 55; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    EXPECT_EQ(true, bpm.FlushPage(temp_page_id));
+    page = bpm.FetchPage(temp_page_id);
+    strcpy(page->GetData(), "resident");
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+
+  BufferAccessStrategy strategy;
+  char expected[MAX_PAGE_SIZE];
+  for (int i = 0; i < 50; ++i) {
+    Page *page = bpm.FetchPage(i, AccessType::SEQUENTIAL_SCAN, &strategy);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  for (int i = 50; i < 55; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), "resident"));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// prefetched pages are read in the background, fetching them is a hit
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager);
+
+  // pages 0..9 end up on disk only
+  for (int i = 0; i < 20; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  int reads = disk_manager->GetNumReads();
+
+  // resident pages are not read again
+  bpm.PrefetchPages({0, 1, 2, 3, 4, 15});
+  for (int retry = 0; retry < 100; ++retry) {
+    if (disk_manager->GetNumReads() == reads + 5) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(reads + 5, disk_manager->GetNumReads());
+
+  char expected[MAX_PAGE_SIZE];
+  for (int i = 0; i < 5; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  EXPECT_EQ(reads + 5, disk_manager->GetNumReads());
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// many threads creating, dirtying and re-reading pages through a pool much
+// smaller than the working set, so most fetches evict a dirty victim
+static void ConcurrentReadWrite(BufferPoolManager &bpm) {
+  const int num_threads = 4;
+  const int pages_per_thread = 50;
+
+  std::vector<std::vector<page_id_t>> page_ids(num_threads);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.push_back(std::thread([&bpm, &page_ids, tid]() {
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id;
+        Page *page = bpm.NewPage(page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+        page_ids[tid].push_back(page_id);
+        EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+
+  // every thread reads back the pages of every other thread
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.push_back(std::thread([&bpm, &page_ids, tid]() {
+      char expected[MAX_PAGE_SIZE];
+      for (int round = 0; round < num_threads; round++) {
+        for (auto page_id : page_ids[(tid + round) % num_threads]) {
+          Page *page = bpm.FetchPage(page_id);
+          ASSERT_NE(nullptr, page);
+          snprintf(expected, PAGE_SIZE, "page %d", page_id);
+          EXPECT_EQ(0, strcmp(page->GetData(), expected));
+          EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(BufferPoolManagerTest, ConcurrencyTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager);
+
+  ConcurrentReadWrite(bpm);
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// hits pin without the pool latch while other fetches evict and reuse the
+// very same frames, every fetch must still see its own page
+TEST(BufferPoolManagerTest, HitConcurrencyTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(8, disk_manager);
+
+  const int num_pages = 12;
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    Page *page = bpm.NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+  }
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; tid++) {
+    threads.push_back(std::thread([&bpm, tid]() {
+      char expected[MAX_PAGE_SIZE];
+      for (int i = 0; i < 2000; i++) {
+        // mostly the four hot pages, now and then a cold one
+        page_id_t page_id = (i % 8 == 0) ? 4 + (i / 8 + tid) % 8 : i % 4;
+        Page *page = bpm.FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        snprintf(expected, PAGE_SIZE, "page %d", page_id);
+        page->RLatch();
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        page->RUnlatch();
+        EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  BufferPoolStatsSnapshot stats = bpm.GetStats();
+  EXPECT_LT(0u, stats.hits);
+  EXPECT_LT(0u, stats.misses);
+  // nothing is left pinned, every frame can be taken again
+  page_id_t page_id;
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(page_id));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// the page cleaner writes unpinned dirty pages without anybody asking
+TEST(BufferPoolManagerTest, CleanerTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager);
+
+  for (int i = 0; i < 10; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  bpm.RunCleanerThread(10, 4);
+
+  // all ten pages show up on disk within a few rounds
+  char data[MAX_PAGE_SIZE];
+  char expected[MAX_PAGE_SIZE];
+  for (int i = 0; i < 10; ++i) {
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    for (int retry = 0; retry < 100; ++retry) {
+      disk_manager->ReadPage(i, data);
+      if (strcmp(data, expected) == 0) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(0, strcmp(data, expected));
+  }
+  bpm.StopCleanerThread();
+  // consecutive pages of a round go to disk with a single write
+  EXPECT_GT(10, disk_manager->GetNumWriteRequests());
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, CleanerConcurrencyTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager);
+  bpm.RunCleanerThread(5, 2);
+
+  ConcurrentReadWrite(bpm);
+
+  bpm.StopCleanerThread();
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// grow a full pool, then shrink it below the pages it holds: dirty pages
+// dropped with their frames must come back from disk
+TEST(BufferPoolManagerTest, ResizeTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager);
+
+  for (int i = 0; i < 10; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+
+  EXPECT_EQ(true, bpm.Resize(20));
+  EXPECT_EQ(20, bpm.GetPoolSize());
+  for (int i = 10; i < 20; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+
+  EXPECT_EQ(false, bpm.Resize(0));
+  EXPECT_EQ(true, bpm.Resize(4));
+  EXPECT_EQ(4, bpm.GetPoolSize());
+  char expected[MAX_PAGE_SIZE];
+  for (int i = 0; i < 20; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+
+  // four frames: a fifth pinned page does not fit
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NE(nullptr, bpm.FetchPage(i));
+  }
+  EXPECT_EQ(nullptr, bpm.FetchPage(4));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// a shrink below the number of pinned frames waits for unpins, while other
+// threads keep fetching
+TEST(BufferPoolManagerTest, ResizeConcurrencyTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager);
+
+  for (int i = 0; i < 10; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+  }
+  std::thread shrink([&bpm]() { EXPECT_EQ(true, bpm.Resize(2)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(10, bpm.GetPoolSize());
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  shrink.join();
+  EXPECT_EQ(2, bpm.GetPoolSize());
+
+  std::thread grow([&bpm]() {
+    for (size_t size = 3; size <= 10; ++size) {
+      EXPECT_EQ(true, bpm.Resize(size));
+    }
+    for (size_t size = 9; size >= 3; --size) {
+      EXPECT_EQ(true, bpm.Resize(size));
+    }
+  });
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 2; ++tid) {
+    readers.push_back(std::thread([&bpm, tid]() {
+      char expected[MAX_PAGE_SIZE];
+      for (int round = 0; round < 20; ++round) {
+        for (int i = tid; i < 10; i += 2) {
+          Page *page = bpm.FetchPage(i);
+          if (page == nullptr) {
+            continue;
+          }
+          snprintf(expected, PAGE_SIZE, "page %d", i);
+          EXPECT_EQ(0, strcmp(page->GetData(), expected));
+          EXPECT_EQ(true, bpm.UnpinPage(i, false));
+        }
+      }
+    }));
+  }
+  grow.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(3, bpm.GetPoolSize());
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+static uint64_t HistogramCount(const LatencyHistogram &histogram) {
+  uint64_t total = 0;
+  for (auto count : histogram) {
+    total += count;
+  }
+  return total;
+}
+
+TEST(BufferPoolManagerTest, StatsTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(3, disk_manager);
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  // hit
+  EXPECT_NE(nullptr, bpm.FetchPage(0));
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+  // evicts dirty page 1
+  EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  // miss, evicts dirty page 2
+  EXPECT_NE(nullptr, bpm.FetchPage(1));
+  EXPECT_EQ(false, bpm.DeletePage(1));
+  EXPECT_EQ(true, bpm.UnpinPage(1, false));
+  EXPECT_EQ(true, bpm.DeletePage(1));
+
+  BufferPoolStatsSnapshot stats = bpm.GetStats();
+  EXPECT_EQ(1, stats.hits);
+  EXPECT_EQ(1, stats.misses);
+  EXPECT_EQ(3, stats.free_list_victims);
+  EXPECT_EQ(2, stats.replacer_victims);
+  EXPECT_EQ(2, stats.dirty_write_backs);
+  EXPECT_EQ(0, stats.cleaner_write_backs);
+  EXPECT_EQ(5, stats.new_pages);
+  EXPECT_EQ(2, stats.delete_pages);
+  EXPECT_EQ(1, stats.pin_failures);
+  EXPECT_DOUBLE_EQ(0.5, stats.HitRatio());
+  EXPECT_EQ(1, HistogramCount(stats.fetch_hit_latency));
+  EXPECT_EQ(1, HistogramCount(stats.fetch_miss_latency));
+  EXPECT_LT(0, BufferPoolStatsSnapshot::Percentile(stats.fetch_miss_latency,
+                                                   0.99));
+
+  bpm.ResetStats();
+  bpm.SetStatsEnabled(false);
+  EXPECT_NE(nullptr, bpm.FetchPage(0));
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+  stats = bpm.GetStats();
+  EXPECT_EQ(0, stats.hits + stats.misses + stats.new_pages);
+  EXPECT_EQ(0, HistogramCount(stats.fetch_hit_latency));
+  EXPECT_DOUBLE_EQ(0, stats.HitRatio());
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+
+// misses of a batch are read in runs of consecutive page ids, one disk
+// request per run; running out of frames leaves nothing pinned
+TEST(BufferPoolManagerTest, FetchPagesTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager writer(12, disk_manager);
+    for (int i = 0; i < 12; ++i) {
+      Page *page = writer.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+      EXPECT_EQ(true, writer.UnpinPage(temp_page_id, true));
+      EXPECT_EQ(true, writer.FlushPage(temp_page_id));
+    }
+  }
+
+  {
+    BufferPoolManager bpm(8, disk_manager);
+    int read_requests = disk_manager->GetNumReadRequests();
+    // runs 0-1, 3 and 6-7
+    std::vector<page_id_t> page_ids = {7, 1, 6, 0, 3};
+    std::vector<Page *> pages;
+    EXPECT_EQ(true, bpm.FetchPages(page_ids, pages));
+    EXPECT_EQ(read_requests + 3, disk_manager->GetNumReadRequests());
+    ASSERT_EQ(page_ids.size(), pages.size());
+    char expected[MAX_PAGE_SIZE];
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      ASSERT_NE(nullptr, pages[i]);
+      EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+      EXPECT_EQ(1, pages[i]->GetPinCount());
+      snprintf(expected, PAGE_SIZE, "page %d", page_ids[i]);
+      EXPECT_EQ(0, strcmp(pages[i]->GetData(), expected));
+    }
+
+    // 6 and 7 are hits, 2 to 5 one run with 3 a hit in the middle: 2 and
+    // 4-5
+    read_requests = disk_manager->GetNumReadRequests();
+    std::vector<page_id_t> more_page_ids = {5, 4, 3, 2, 6, 7};
+    EXPECT_EQ(true, bpm.FetchPages(more_page_ids, pages));
+    EXPECT_EQ(read_requests + 2, disk_manager->GetNumReadRequests());
+    EXPECT_EQ(2, pages[4]->GetPinCount());
+    EXPECT_EQ(true, bpm.UnpinPages(more_page_ids,
+                                   {false, false, false, false, false, true}));
+    EXPECT_EQ(true,
+              bpm.UnpinPages(page_ids, {false, false, false, false, false}));
+    EXPECT_EQ(false, bpm.UnpinPages({7}, {false}));
+  }
+
+  BufferPoolManager bpm(4, disk_manager);
+  EXPECT_NE(nullptr, bpm.FetchPage(6));
+  std::vector<page_id_t> page_ids = {7, 0, 6, 5, 1};
+  std::vector<Page *> pages;
+  EXPECT_EQ(false, bpm.FetchPages(page_ids, pages));
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (auto page : pages) {
+    EXPECT_EQ(nullptr, page);
+  }
+  EXPECT_EQ(true, bpm.UnpinPage(6, false));
+  EXPECT_EQ(false, bpm.UnpinPage(6, false));
+  // every frame is free again
+  page_ids = {8, 9, 10, 11};
+  EXPECT_EQ(true, bpm.FetchPages(page_ids, pages));
+  EXPECT_EQ(true, bpm.UnpinPages(page_ids, {false, false, false, false}));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+
+// only dirty pages are written, a run of consecutive page ids per request
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(10, disk_manager);
+    for (int i = 0; i < 10; ++i) {
+      Page *page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    }
+    // dirty: 0-2, 4-5 and 8, the last one still pinned
+    bool dirty[] = {true, true, true, false, true,
+                    true, false, false, true, false};
+    for (int i = 0; i < 10; ++i) {
+      if (i != 8) {
+        EXPECT_EQ(true, bpm.UnpinPage(i, dirty[i]));
+      }
+    }
+    EXPECT_EQ(true, bpm.UnpinPage(8, true));
+    EXPECT_NE(nullptr, bpm.FetchPage(8));
+
+    int write_requests = disk_manager->GetNumWriteRequests();
+    EXPECT_EQ(4, bpm.FlushDirtyPages(
+                     [](page_id_t page_id) { return page_id < 5; }));
+    EXPECT_EQ(write_requests + 2, disk_manager->GetNumWriteRequests());
+    EXPECT_EQ(2, bpm.FlushAllPages());
+    EXPECT_EQ(write_requests + 4, disk_manager->GetNumWriteRequests());
+    EXPECT_EQ(0, bpm.FlushAllPages());
+    EXPECT_EQ(write_requests + 4, disk_manager->GetNumWriteRequests());
+    // the flush let go of its own pins
+    EXPECT_EQ(2, bpm.FetchPage(8)->GetPinCount());
+    EXPECT_EQ(true, bpm.UnpinPage(8, false));
+    EXPECT_EQ(true, bpm.UnpinPage(8, false));
+  }
+
+  BufferPoolManager bpm(10, disk_manager);
+  char expected[MAX_PAGE_SIZE];
+  for (page_id_t page_id : {0, 1, 2, 4, 5, 8}) {
+    Page *page = bpm.FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+
+// frame data is page aligned and contiguous per arena, apart from the
+// metadata; a grown pool gets a new arena
+TEST(BufferPoolManagerTest, FrameArenaTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(8, disk_manager);
+  std::vector<Page *> pages;
+  for (int i = 0; i < 8; ++i) {
+    pages.push_back(bpm.NewPage(temp_page_id));
+    ASSERT_NE(nullptr, pages.back());
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pages.back()->GetData()) %
+                     PAGE_SIZE);
+  }
+  std::sort(pages.begin(), pages.end(), [](Page *a, Page *b) {
+    return a->GetFrameId() < b->GetFrameId();
+  });
+  for (size_t i = 1; i < pages.size(); ++i) {
+    EXPECT_EQ(pages[i - 1]->GetData() + PAGE_SIZE, pages[i]->GetData());
+  }
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+
+  // shrink into the first arena, grow back and beyond
+  EXPECT_EQ(true, bpm.Resize(2));
+  EXPECT_EQ(true, bpm.Resize(4096 + 8));
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < 4096 + 8; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    page_ids.push_back(temp_page_id);
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(true, bpm.Resize(3));
+  char expected[MAX_PAGE_SIZE];
+  for (auto page_id : page_ids) {
+    Page *page = bpm.FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+
+// evicted pages come back from the compressed tier instead of the disk
+TEST(BufferPoolManagerTest, CompressedTierTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(4, disk_manager);
+  bpm.SetCompressedTierBudget(64 * PAGE_SIZE);
+  for (int i = 0; i < 12; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+
+  // 0-7 were evicted, 4-7 push 8-11 out in turn
+  int reads = disk_manager->GetNumReads();
+  char expected[MAX_PAGE_SIZE];
+  for (int i = 0; i < 8; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  EXPECT_EQ(reads, disk_manager->GetNumReads());
+  EXPECT_EQ(8, bpm.GetStats().compressed_tier_hits);
+
+  // without a budget it is back to the disk
+  bpm.SetCompressedTierBudget(0);
+  for (int i = 8; i < 12; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  EXPECT_EQ(reads + 4, disk_manager->GetNumReads());
+  EXPECT_EQ(8, bpm.GetStats().compressed_tier_hits);
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, VictimCacheTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(4, disk_manager);
+  EXPECT_EQ(true, bpm.EnableVictimCache("test.cache", 16));
+  EXPECT_EQ(false, bpm.EnableVictimCache("test.cache2", 16));
+  for (int i = 0; i < 12; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+
+  // 0-7 were spilled into the cache file, not read back from test.db
+  int reads = disk_manager->GetNumReads();
+  char expected[MAX_PAGE_SIZE];
+  for (int i = 0; i < 8; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  EXPECT_EQ(reads, disk_manager->GetNumReads());
+  EXPECT_EQ(8, bpm.GetStats().victim_cache_hits);
+
+  // deleting 8, which is in the cache and not in the pool, still drops it
+  // from the cache
+  EXPECT_EQ(false, bpm.DeletePage(8));
+  Page *page = bpm.FetchPage(8);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(reads + 1, disk_manager->GetNumReads());
+  EXPECT_EQ(8, bpm.GetStats().victim_cache_hits);
+  EXPECT_EQ(true, bpm.UnpinPage(8, false));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// behind a compressed tier the victim cache only gets what the tier drops
+TEST(BufferPoolManagerTest, ExclusiveTiersTest) {
+  page_id_t temp_page_id;
+  char data[MAX_PAGE_SIZE];
+
+  // what a page of the test takes in the tier
+  CompressedTier probe(64 * PAGE_SIZE);
+  memset(data, 0, PAGE_SIZE);
+  snprintf(data, PAGE_SIZE, "page %d", 0);
+  EXPECT_EQ(true, probe.Put(0, data));
+  size_t entry_size = probe.GetMemoryUsage();
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(4, disk_manager);
+  bpm.SetCompressedTierBudget(4 * entry_size);
+  EXPECT_EQ(true, bpm.EnableVictimCache("test.cache", 4));
+  for (int i = 0; i < 12; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+
+  // 4-7 are in the tier, it dropped 0-3 into the cache. Enough frames for
+  // all of them, so that fetching evicts nothing
+  EXPECT_EQ(true, bpm.Resize(16));
+  int reads = disk_manager->GetNumReads();
+  for (int i = 0; i < 8; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(data, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), data));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  EXPECT_EQ(reads, disk_manager->GetNumReads());
+  EXPECT_EQ(4, bpm.GetStats().compressed_tier_hits);
+  EXPECT_EQ(4, bpm.GetStats().victim_cache_hits);
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, PagePriorityTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(4, disk_manager);
+  bpm.SetPagePriority(HEADER_PAGE_ID, PagePriority::HIGH);
+  for (int i = 0; i < 4; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i == HEADER_PAGE_ID ? PagePriority::HIGH : PagePriority::NORMAL,
+              page->GetPriority());
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+  }
+  bpm.SetPagePriority(1, PagePriority::HIGH);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+
+  // 0 and 1 are older than 2 and 3 but outlive them
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+  int reads = disk_manager->GetNumReads();
+  for (int i = 0; i < 2; ++i) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(PagePriority::HIGH, page->GetPriority());
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  EXPECT_EQ(reads, disk_manager->GetNumReads());
+
+  // back to NORMAL, 1 goes before the header page
+  bpm.SetPagePriority(1, PagePriority::NORMAL);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  Page *page = bpm.FetchPage(HEADER_PAGE_ID);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(reads, disk_manager->GetNumReads());
+  EXPECT_EQ(true, bpm.UnpinPage(HEADER_PAGE_ID, false));
+
+  // the priority outlives the eviction: 2 comes back as HIGH
+  bpm.SetPagePriority(2, PagePriority::HIGH);
+  page = bpm.FetchPage(2);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(reads + 1, disk_manager->GetNumReads());
+  EXPECT_EQ(PagePriority::HIGH, page->GetPriority());
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 2"));
+  EXPECT_EQ(true, bpm.UnpinPage(2, false));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, TraceTest) {
+  page_id_t page_id_0, page_id_1;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(2, disk_manager);
+  EXPECT_EQ(true, bpm.StartTrace("test.trace"));
+  ASSERT_NE(nullptr, bpm.NewPage(page_id_0));
+  EXPECT_EQ(true, bpm.UnpinPage(page_id_0, true));
+  ASSERT_NE(nullptr, bpm.NewPage(page_id_1));
+  EXPECT_EQ(true, bpm.UnpinPage(page_id_1, false));
+  ASSERT_NE(nullptr, bpm.FetchPage(page_id_0, AccessType::SEQUENTIAL_SCAN));
+  EXPECT_EQ(true, bpm.UnpinPage(page_id_0, false));
+  EXPECT_EQ(true, bpm.DeletePage(page_id_1));
+  bpm.StopTrace();
+  // not recorded
+  ASSERT_NE(nullptr, bpm.FetchPage(page_id_0));
+  EXPECT_EQ(true, bpm.UnpinPage(page_id_0, false));
+
+  std::vector<TraceRecord> records;
+  ASSERT_EQ(true, BufferPoolTrace::Read("test.trace", records));
+  ASSERT_EQ(7, records.size());
+  TraceOp ops[] = {TraceOp::NEW,   TraceOp::UNPIN, TraceOp::NEW,
+                   TraceOp::UNPIN, TraceOp::FETCH, TraceOp::UNPIN,
+                   TraceOp::DELETE};
+  page_id_t page_ids[] = {page_id_0, page_id_0, page_id_1, page_id_1,
+                          page_id_0, page_id_0, page_id_1};
+  bool flags[] = {false, true, false, false, true, false, false};
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(ops[i], records[i].op_);
+    EXPECT_EQ(page_ids[i], records[i].page_id_);
+    EXPECT_EQ(flags[i], records[i].flag_ != 0);
+    EXPECT_EQ(records[0].thread_, records[i].thread_);
+    if (i > 0) {
+      EXPECT_LE(records[i - 1].time_ns_, records[i].time_ns_);
+    }
+  }
+
+  // with one frame the fetch misses, with two it hits
+  ReplayResult result =
+      TraceReplayer(1, ReplacerType::LRU, LRUK_REPLACER_K, "replay.db")
+          .Replay(records);
+  EXPECT_EQ(0, result.stats_.hits);
+  EXPECT_EQ(1, result.stats_.misses);
+  EXPECT_EQ(1, result.disk_reads_);
+  EXPECT_EQ(0, result.failed_calls_);
+  result = TraceReplayer(2, ReplacerType::CLOCK, LRUK_REPLACER_K, "replay.db")
+               .Replay(records);
+  EXPECT_EQ(1, result.stats_.hits);
+  EXPECT_EQ(0, result.stats_.misses);
+  EXPECT_EQ(0, result.disk_reads_);
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.trace");
+}
+
+// a FetchPage that found every frame pinned is traced as failed, and not
+// replayed, whatever the size of the replay pool
+TEST(BufferPoolManagerTest, FailedFetchTraceTest) {
+  page_id_t page_id_0, page_id_1;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(1, disk_manager);
+  EXPECT_EQ(true, bpm.StartTrace("test.trace"));
+  ASSERT_NE(nullptr, bpm.NewPage(page_id_0));
+  EXPECT_EQ(true, bpm.UnpinPage(page_id_0, true));
+  ASSERT_NE(nullptr, bpm.NewPage(page_id_1));
+  EXPECT_EQ(nullptr, bpm.FetchPage(page_id_0));
+  EXPECT_EQ(true, bpm.UnpinPage(page_id_1, false));
+  bpm.StopTrace();
+
+  std::vector<TraceRecord> records;
+  ASSERT_EQ(true, BufferPoolTrace::Read("test.trace", records));
+  ASSERT_EQ(5, records.size());
+  EXPECT_EQ(TraceOp::FETCH, records[3].op_);
+  EXPECT_EQ(INVALID_PAGE_ID, records[3].page_id_);
+
+  for (size_t pool_size : {1, 2}) {
+    ReplayResult result =
+        TraceReplayer(pool_size, ReplacerType::LRU, LRUK_REPLACER_K,
+                      "replay.db")
+            .Replay(records);
+    EXPECT_EQ(0, result.stats_.hits);
+    EXPECT_EQ(0, result.stats_.misses);
+    EXPECT_EQ(0, result.failed_calls_);
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.trace");
+}
+
 } // namespace cmudb
@@ -0,0 +1,73 @@
+/**
+ * clock_replacer_test.cpp
+ */
+
+#include <cstdio>
+
+#include "buffer/clock_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(ClockReplacerTest, SampleTest) {
+  ClockReplacer<int> clock_replacer(7);
+
+  // push element into replacer
+  clock_replacer.Insert(1);
+  clock_replacer.Insert(2);
+  clock_replacer.Insert(3);
+  clock_replacer.Insert(4);
+  clock_replacer.Insert(5);
+  clock_replacer.Insert(6);
+  clock_replacer.Insert(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  // every slot is referenced, so the first sweep only clears reference bits
+  // and the victims come out in slot order
+  int value;
+  clock_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+
+  // remove element from replacer
+  EXPECT_EQ(false, clock_replacer.Erase(3));
+  EXPECT_EQ(true, clock_replacer.Erase(5));
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  // touching 4 gives it a second chance, so 6 goes first
+  clock_replacer.Insert(4);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(6, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+}
+
+TEST(ClockReplacerTest, BasicTest) {
+  // start small so inserts have to grow the slot array
+  ClockReplacer<int> clock_replacer(10);
+
+  for (int i = 0; i < 100; ++i) {
+    clock_replacer.Insert(i);
+  }
+  EXPECT_EQ(100, clock_replacer.Size());
+
+  // erase the lower half
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ(true, clock_replacer.Erase(i));
+  }
+  EXPECT_EQ(50, clock_replacer.Size());
+
+  // check left
+  int value = -1;
+  for (int i = 50; i < 100; ++i) {
+    EXPECT_EQ(true, clock_replacer.Victim(value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+} // namespace cmudb
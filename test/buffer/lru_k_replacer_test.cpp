@@ -0,0 +1,84 @@
+/**
+ * lru_k_replacer_test.cpp
+ */
+
+#include <cstdio>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer<int> lru_k_replacer(2);
+
+  // 1..5 are accessed once, 1 a second time
+  for (int i = 1; i <= 5; ++i) {
+    lru_k_replacer.RecordAccess(i);
+  }
+  lru_k_replacer.RecordAccess(1);
+  for (int i = 1; i <= 5; ++i) {
+    lru_k_replacer.Insert(i);
+  }
+  EXPECT_EQ(5, lru_k_replacer.Size());
+
+  // frames with fewer than k accesses go first, oldest first, even though 1
+  // was touched before all of them
+  int value;
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+
+  // pinned frames are not candidates
+  lru_k_replacer.RecordAccess(4);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+  EXPECT_EQ(false, lru_k_replacer.Erase(4));
+  EXPECT_EQ(true, lru_k_replacer.Erase(5));
+  lru_k_replacer.Insert(4);
+  lru_k_replacer.Insert(5);
+
+  // 4 has two accesses now, 5 still one
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(5, value);
+
+  // among frames with k accesses the oldest k-th access goes first: 1 was
+  // accessed at t0 and t5, 4 at t3 and t6
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(false, lru_k_replacer.Victim(value));
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer<int> lru_k_replacer(2);
+
+  // hot frames 0..9 are referenced twice
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < 10; ++i) {
+      lru_k_replacer.RecordAccess(i);
+      lru_k_replacer.Insert(i);
+    }
+  }
+  // a scan touches 10..99 once each, after the hot frames
+  for (int i = 10; i < 100; ++i) {
+    lru_k_replacer.RecordAccess(i);
+    lru_k_replacer.Insert(i);
+  }
+  EXPECT_EQ(100, lru_k_replacer.Size());
+
+  // the whole scan is evicted before any hot frame
+  int value = -1;
+  for (int i = 10; i < 100; ++i) {
+    lru_k_replacer.Victim(value);
+    EXPECT_EQ(i, value);
+  }
+  for (int i = 0; i < 10; ++i) {
+    lru_k_replacer.Victim(value);
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+} // namespace cmudb
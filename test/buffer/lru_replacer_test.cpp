@@ -71,4 +71,22 @@ TEST(LRUReplacerTest, BasicTest) {
   }
 }
 
+TEST(LRUReplacerTest, EvictionCandidatesTest) {
+  LRUReplacer<int> lru_replacer;
+  for (int i = 0; i < 5; ++i) {
+    lru_replacer.Insert(i);
+  }
+  lru_replacer.Insert(0);
+
+  // coldest first, nothing is removed
+  std::vector<int> candidates;
+  lru_replacer.EvictionCandidates(candidates, 3);
+  EXPECT_EQ(std::vector<int>({1, 2, 3}), candidates);
+  EXPECT_EQ(5, lru_replacer.Size());
+
+  candidates.clear();
+  lru_replacer.EvictionCandidates(candidates, 10);
+  EXPECT_EQ(std::vector<int>({1, 2, 3, 4, 0}), candidates);
+}
+
 } // namespace cmudb
@@ -0,0 +1,129 @@
+/**
+ * page_guard_test.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <utility>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(PageGuardTest, SampleTest) {
+  page_id_t page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(2, disk_manager);
+  {
+    WritePageGuard guard = bpm.NewPageGuarded(page_id);
+    ASSERT_TRUE(static_cast<bool>(guard));
+    EXPECT_EQ(page_id, guard.GetPageId());
+    EXPECT_EQ(1, guard.GetPage()->GetPinCount());
+    strcpy(guard.GetDataMut(), "Hello");
+    EXPECT_TRUE(guard.IsDirty());
+  }
+  // unpinned on scope exit, so both frames can be used again
+  page_id_t other_page_id;
+  {
+    WritePageGuard first = bpm.NewPageGuarded(other_page_id);
+    WritePageGuard second = bpm.NewPageGuarded(other_page_id);
+    EXPECT_TRUE(static_cast<bool>(second));
+    // every frame is pinned
+    WritePageGuard third = bpm.NewPageGuarded(other_page_id);
+    EXPECT_FALSE(static_cast<bool>(third));
+    EXPECT_FALSE(static_cast<bool>(bpm.FetchPageRead(page_id)));
+  }
+
+  // page_id was evicted dirty and reads back
+  {
+    ReadPageGuard guard = bpm.FetchPageRead(page_id);
+    ASSERT_TRUE(static_cast<bool>(guard));
+    EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+    // readers share the page
+    ReadPageGuard other = bpm.FetchPageRead(page_id);
+    EXPECT_EQ(2, guard.GetPage()->GetPinCount());
+
+    // a move hands over latch and pin, the source is empty
+    ReadPageGuard moved(std::move(other));
+    EXPECT_FALSE(static_cast<bool>(other));
+    EXPECT_EQ(2, moved.GetPage()->GetPinCount());
+    moved.Release();
+    EXPECT_EQ(1, guard.GetPage()->GetPinCount());
+    moved.Release();
+    EXPECT_EQ(1, guard.GetPage()->GetPinCount());
+  }
+  Page *page = bpm.FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(1, page->GetPinCount());
+  EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(PageGuardTest, UpgradeTest) {
+  page_id_t page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(2, disk_manager);
+  bpm.NewPageGuarded(page_id);
+
+  ReadPageGuard read_guard = bpm.FetchPageRead(page_id);
+  uint64_t version = read_guard.GetPage()->ReadVersion();
+  WritePageGuard write_guard = read_guard.TryUpgrade();
+  ASSERT_TRUE(static_cast<bool>(write_guard));
+  EXPECT_FALSE(static_cast<bool>(read_guard));
+  EXPECT_FALSE(write_guard.IsDirty());
+  // nobody wrote in between: the version only moved by the upgrade
+  EXPECT_EQ(version + 1, write_guard.GetPage()->ReadVersion());
+  strcpy(write_guard.GetDataMut(), "upgraded");
+  write_guard.Release();
+
+  // with a writer waiting for our read latch, upgrading would deadlock
+  read_guard = bpm.FetchPageRead(page_id);
+  std::thread writer([&bpm, page_id] {
+    WritePageGuard guard = bpm.FetchPageWrite(page_id);
+    EXPECT_TRUE(static_cast<bool>(guard));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(static_cast<bool>(read_guard.TryUpgrade()));
+  EXPECT_TRUE(static_cast<bool>(read_guard));
+  read_guard.Release();
+  writer.join();
+  EXPECT_EQ(0, strcmp(bpm.FetchPageRead(page_id).GetData(), "upgraded"));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(PageGuardTest, ParallelTest) {
+  page_id_t page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // unpinning through the frame finds the shard of the page
+  ParallelBufferPoolManager bpm(2, 1, disk_manager);
+  for (int i = 0; i < 4; ++i) {
+    WritePageGuard guard = bpm.NewPageGuarded(page_id);
+    ASSERT_TRUE(static_cast<bool>(guard));
+    snprintf(guard.GetDataMut(), PAGE_SIZE, "page %d", page_id);
+  }
+  for (int i = 0; i < 4; ++i) {
+    char expected[MAX_PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    ReadPageGuard guard = bpm.FetchPageRead(i);
+    ASSERT_TRUE(static_cast<bool>(guard));
+    EXPECT_EQ(0, strcmp(guard.GetData(), expected));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
@@ -0,0 +1,125 @@
+/**
+ * parallel_buffer_pool_manager_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // 5 shards with 2 frames each
+  ParallelBufferPoolManager bpm(5, 2, disk_manager);
+  EXPECT_EQ(10, bpm.GetPoolSize());
+
+  auto page_zero = bpm.NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, temp_page_id);
+  strcpy(page_zero->GetData(), "Hello");
+
+  // round-robin allocation keeps page ids dense
+  for (int i = 1; i < 10; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(i, temp_page_id);
+  }
+  // all the frames of all the shards are pinned
+  for (int i = 10; i < 15; ++i) {
+    EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  }
+  // unpin the first five pages, one per shard
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  // each new page evicts the unpinned page of its own shard
+  for (int i = 10; i < 14; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(i, temp_page_id);
+  }
+  // page zero lives in shard 0, make room there and read it back
+  EXPECT_EQ(true, bpm.UnpinPage(10, false));
+  page_zero = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, strcmp(page_zero->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+  EXPECT_EQ(false, bpm.UnpinPage(0, false));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// pools sharing a disk manager never hand out the same page id
+TEST(ParallelBufferPoolManagerTest, SharedDiskManagerTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  ParallelBufferPoolManager parallel_bpm(2, 4, disk_manager);
+  BufferPoolManager bpm(4, disk_manager);
+
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, parallel_bpm.NewPage(temp_page_id));
+    page_ids.push_back(temp_page_id);
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    page_ids.push_back(temp_page_id);
+  }
+  std::sort(page_ids.begin(), page_ids.end());
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(i, page_ids[i]);
+  }
+  for (int i = 0; i < 8; i += 2) {
+    EXPECT_EQ(true, parallel_bpm.UnpinPage(i, false));
+    EXPECT_EQ(true, bpm.UnpinPage(i + 1, false));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// a full shard makes NewPage move on to the next one, and the id it skipped
+// is handed out once its shard has a frame again
+TEST(ParallelBufferPoolManagerTest, FullShardTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  ParallelBufferPoolManager parallel_bpm(2, 2, disk_manager);
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, parallel_bpm.NewPage(temp_page_id));
+    EXPECT_EQ(i, temp_page_id);
+  }
+  // shard 0 stays full, shard 1 gets its frames back
+  EXPECT_EQ(true, parallel_bpm.UnpinPage(1, false));
+  EXPECT_EQ(true, parallel_bpm.UnpinPage(3, false));
+
+  ASSERT_NE(nullptr, parallel_bpm.NewPage(temp_page_id));
+  EXPECT_EQ(5, temp_page_id);
+  ASSERT_NE(nullptr, parallel_bpm.NewPage(temp_page_id));
+  EXPECT_EQ(7, temp_page_id);
+  EXPECT_EQ(nullptr, parallel_bpm.NewPage(temp_page_id));
+
+  // the skipped ids of shard 0 come back before any new id
+  EXPECT_EQ(true, parallel_bpm.UnpinPage(0, false));
+  ASSERT_NE(nullptr, parallel_bpm.NewPage(temp_page_id));
+  EXPECT_EQ(4, temp_page_id);
+  EXPECT_EQ(true, parallel_bpm.UnpinPage(4, false));
+  ASSERT_NE(nullptr, parallel_bpm.NewPage(temp_page_id));
+  EXPECT_EQ(6, temp_page_id);
+
+  EXPECT_EQ(false, parallel_bpm.Resize(1));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
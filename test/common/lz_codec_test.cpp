@@ -0,0 +1,80 @@
+/**
+ * lz_codec_test.cpp
+ */
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/lz_codec.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+static void RoundTrip(const std::string &input, bool compressible) {
+  std::vector<char> compressed(input.size() + input.size() / 8 + 16);
+  int size = LZCodec::Compress(input.data(), input.size(), compressed.data(),
+                               compressed.size());
+  ASSERT_LT(0, size);
+  if (compressible) {
+    EXPECT_GT(input.size() / 2, static_cast<size_t>(size));
+  }
+  std::vector<char> output(input.size() + 1);
+  EXPECT_EQ(static_cast<int>(input.size()),
+            LZCodec::Decompress(compressed.data(), size, output.data(),
+                                output.size()));
+  EXPECT_EQ(0, memcmp(input.data(), output.data(), input.size()));
+}
+
+TEST(LZCodecTest, RoundTripTest) {
+  std::mt19937 random(15445);
+  // short inputs are all literals
+  for (int n = 0; n < 16; ++n) {
+    RoundTrip(std::string(n, 'x'), false);
+  }
+  // zeros, with long runs that need extra length bytes
+  RoundTrip(std::string(512, '\0'), true);
+  RoundTrip(std::string(65536, '\0'), true);
+  // a page of tuples with a few distinct values
+  std::string tuples;
+  while (tuples.size() < 8192) {
+    tuples += "id=" + std::to_string(random() % 100) + ";name=tuple;pad=";
+    tuples += std::string(random() % 300, ' ');
+  }
+  RoundTrip(tuples, true);
+  // random bytes do not compress but still round trip
+  std::string noise;
+  for (int i = 0; i < 4096; ++i) {
+    noise += static_cast<char>(random());
+  }
+  RoundTrip(noise, false);
+}
+
+TEST(LZCodecTest, LimitTest) {
+  std::mt19937 random(15445);
+  std::string noise;
+  for (int i = 0; i < 512; ++i) {
+    noise += static_cast<char>(random());
+  }
+  std::vector<char> compressed(512);
+  // does not fit into less than its own size
+  EXPECT_EQ(0, LZCodec::Compress(noise.data(), noise.size(),
+                                 compressed.data(), 448));
+
+  std::string zeros(4096, '\0');
+  int size = LZCodec::Compress(zeros.data(), zeros.size(), compressed.data(),
+                               compressed.size());
+  ASSERT_LT(0, size);
+  std::vector<char> output(4096);
+  // output too small, truncated and corrupted input
+  EXPECT_EQ(-1, LZCodec::Decompress(compressed.data(), size, output.data(),
+                                    4095));
+  EXPECT_EQ(-1, LZCodec::Decompress(compressed.data(), size - 1,
+                                    output.data(), output.size()));
+  compressed[2] = 0x7f; // offset before the start of the output
+  EXPECT_EQ(-1, LZCodec::Decompress(compressed.data(), size, output.data(),
+                                    output.size()));
+}
+
+} // namespace cmudb
@@ -2,6 +2,7 @@
  * extendible_hash_test.cpp
  */
 
+#include <atomic>
 #include <thread>
 
 #include "hash/extendible_hash.h"
@@ -9,6 +10,17 @@
 
 namespace cmudb {
 
+// the first key whose hash ends in the 8 bits of low_bits. The depth tests
+// use these instead of the plain low_bits, they split as if keys hashed to
+// themselves
+template <typename V>
+static int KeyFor(ExtendibleHash<int, V> *test, int low_bits) {
+  int key = 0;
+  while ((test->HashKey(key) & 0xff) != static_cast<size_t>(low_bits)) {
+    key++;
+  }
+  return key;
+}
 
 TEST(ExtendibleHashTest, SampleTest) {
   // set leaf size as 2
@@ -16,15 +28,15 @@ TEST(ExtendibleHashTest, SampleTest) {
       new ExtendibleHash<int, std::string>(2);
 
   // insert several key/value pairs
-  test->Insert(1, "a");
-  test->Insert(2, "b");
-  test->Insert(3, "c");
-  test->Insert(4, "d");
-  test->Insert(5, "e");
-  test->Insert(6, "f");
-  test->Insert(7, "g");
-  test->Insert(8, "h");
-  test->Insert(9, "i");
+  test->Insert(KeyFor(test, 1), "a");
+  test->Insert(KeyFor(test, 2), "b");
+  test->Insert(KeyFor(test, 3), "c");
+  test->Insert(KeyFor(test, 4), "d");
+  test->Insert(KeyFor(test, 5), "e");
+  test->Insert(KeyFor(test, 6), "f");
+  test->Insert(KeyFor(test, 7), "g");
+  test->Insert(KeyFor(test, 8), "h");
+  test->Insert(KeyFor(test, 9), "i");
   EXPECT_EQ(2, test->GetLocalDepth(0));
   EXPECT_EQ(3, test->GetLocalDepth(1));
   EXPECT_EQ(2, test->GetLocalDepth(2));
@@ -32,19 +44,19 @@ TEST(ExtendibleHashTest, SampleTest) {
 
   // find test
   std::string result;
-  test->Find(9, result);
+  test->Find(KeyFor(test, 9), result);
   EXPECT_EQ("i", result);
-  test->Find(8, result);
+  test->Find(KeyFor(test, 8), result);
   EXPECT_EQ("h", result);
-  test->Find(2, result);
+  test->Find(KeyFor(test, 2), result);
   EXPECT_EQ("b", result);
-  EXPECT_EQ(0, test->Find(10, result));
+  EXPECT_EQ(0, test->Find(KeyFor(test, 10), result));
 
   // delete test
-  EXPECT_EQ(1, test->Remove(8));
-  EXPECT_EQ(1, test->Remove(4));
-  EXPECT_EQ(1, test->Remove(1));
-  EXPECT_EQ(0, test->Remove(20));
+  EXPECT_EQ(1, test->Remove(KeyFor(test, 8)));
+  EXPECT_EQ(1, test->Remove(KeyFor(test, 4)));
+  EXPECT_EQ(1, test->Remove(KeyFor(test, 1)));
+  EXPECT_EQ(0, test->Remove(KeyFor(test, 20)));
 
   delete test;
 }
@@ -57,9 +69,9 @@ TEST(ExtendibleHashTest, BasicDepthTest) {
       new ExtendibleHash<int, std::string>(2);
 
   // insert several key/value pairs
-  test->Insert(6, "a");   // b'0110
-  test->Insert(10, "b");  // b'1010
-  test->Insert(14, "c");  // b'1110
+  test->Insert(KeyFor(test, 6), "a");   // b'0110
+  test->Insert(KeyFor(test, 10), "b");  // b'1010
+  test->Insert(KeyFor(test, 14), "c");  // b'1110
 
   EXPECT_EQ(3, test->GetGlobalDepth());
 
@@ -79,26 +91,26 @@ TEST(ExtendibleHashTest, BasicDepthTest) {
   EXPECT_EQ(2, test->GetNumBuckets());
 
   // insert more key/value pairs
-  test->Insert(1, "d");
+  test->Insert(KeyFor(test, 1), "d");
   printf("insert e....\n");
-  test->Insert(3, "e");
+  test->Insert(KeyFor(test, 3), "e");
   printf("insert f....\n");
-  test->Insert(5, "f");
+  test->Insert(KeyFor(test, 5), "f");
 
   std::string result;
-  test->Find(10, result);
+  test->Find(KeyFor(test, 10), result);
   EXPECT_EQ("b", result);
   result = "";
 
-  test->Find(1, result);
+  test->Find(KeyFor(test, 1), result);
   EXPECT_EQ("d", result);
   result = "";
 
-  test->Find(3, result);
+  test->Find(KeyFor(test, 3), result);
   EXPECT_EQ("e", result);
   result = "";
 
-  test->Find(5, result);
+  test->Find(KeyFor(test, 5), result);
   EXPECT_EQ("f", result);
 
   EXPECT_EQ(5, test->GetNumBuckets());
@@ -117,9 +129,13 @@ TEST(ExtendibleHashTest, ConcurrentInsertTest) {
   for (int run = 0; run < num_runs; run++) {
     std::shared_ptr<ExtendibleHash<int, int>> test{new ExtendibleHash<int, int>(2)};
     std::vector<std::thread> threads;
+    std::vector<int> keys;
+    for (int tid = 0; tid < num_threads; tid++) {
+      keys.push_back(KeyFor(test.get(), tid));
+    }
     for (int tid = 0; tid < num_threads; tid++) {
-      threads.push_back(std::thread([tid, &test]() {
-        test->Insert(tid, tid);
+      threads.push_back(std::thread([tid, &test, &keys]() {
+        test->Insert(keys[tid], tid);
       }));
     }
     for (int i = 0; i < num_threads; i++) {
@@ -128,7 +144,7 @@ TEST(ExtendibleHashTest, ConcurrentInsertTest) {
     EXPECT_EQ(test->GetGlobalDepth(), 1);
     for (int i = 0; i < num_threads; i++) {
       int val;
-      EXPECT_TRUE(test->Find(i, val));
+      EXPECT_TRUE(test->Find(keys[i], val));
       EXPECT_EQ(val, i);
     }
   }
@@ -140,15 +156,22 @@ TEST(ExtendibleHashTest, ConcurrentRemoveTest) {
   for (int run = 0; run < num_runs; run++) {
     std::shared_ptr<ExtendibleHash<int, int>> test{new ExtendibleHash<int, int>(2)};
     std::vector<std::thread> threads;
-    std::vector<int> values{0, 10, 16, 32, 64};
+    std::vector<int> values;
+    std::vector<int> inserted;
+    for (int bits : {0, 10, 16, 32, 64}) {
+      values.push_back(KeyFor(test.get(), bits));
+    }
+    for (int tid = 0; tid < num_threads; tid++) {
+      inserted.push_back(KeyFor(test.get(), tid + 4));
+    }
     for (int value : values) {
       test->Insert(value, value);
     }
     EXPECT_EQ(test->GetGlobalDepth(), 6);
     for (int tid = 0; tid < num_threads; tid++) {
-      threads.push_back(std::thread([tid, &test, &values]() {
+      threads.push_back(std::thread([tid, &test, &values, &inserted]() {
         test->Remove(values[tid]);
-        test->Insert(tid + 4, tid + 4);
+        test->Insert(inserted[tid], tid + 4);
       }));
     }
     for (int i = 0; i < num_threads; i++) {
@@ -156,12 +179,133 @@ TEST(ExtendibleHashTest, ConcurrentRemoveTest) {
     }
     EXPECT_EQ(test->GetGlobalDepth(), 6);
     int val;
-    EXPECT_EQ(0, test->Find(0, val));
-    EXPECT_EQ(1, test->Find(8, val));
-    EXPECT_EQ(0, test->Find(16, val));
-    EXPECT_EQ(0, test->Find(3, val));
-    EXPECT_EQ(1, test->Find(4, val));
+    EXPECT_EQ(0, test->Find(KeyFor(test.get(), 0), val));
+    EXPECT_EQ(1, test->Find(KeyFor(test.get(), 8), val));
+    EXPECT_EQ(0, test->Find(KeyFor(test.get(), 16), val));
+    EXPECT_EQ(0, test->Find(KeyFor(test.get(), 3), val));
+    EXPECT_EQ(1, test->Find(KeyFor(test.get(), 4), val));
+  }
+}
+
+// many threads inserting, finding and removing at once, with small buckets
+// so that splits and directory growth race with everything else
+TEST(ExtendibleHashTest, ConcurrentStressTest) {
+  const int num_threads = 16;
+  const int keys_per_thread = 2000;
+  ExtendibleHash<int, int> test(4);
+  std::atomic<int> wrong_finds(0);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.push_back(std::thread([tid, &test, &wrong_finds]() {
+      // every thread owns the keys congruent to tid
+      for (int i = 0; i < keys_per_thread; i++) {
+        int key = i * num_threads + tid;
+        test.Insert(key, key * 2);
+        int val;
+        if (!test.Find(key, val) || val != key * 2) {
+          wrong_finds++;
+        }
+        // the keys of other threads are there or not, never wrong
+        int other =
+            (i * num_threads + tid + 1) % (num_threads * keys_per_thread);
+        if (test.Find(other, val) && val != other * 2) {
+          wrong_finds++;
+        }
+      }
+      // drop every odd one again
+      for (int i = 1; i < keys_per_thread; i += 2) {
+        if (!test.Remove(i * num_threads + tid)) {
+          wrong_finds++;
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, wrong_finds);
+  for (int key = 0; key < num_threads * keys_per_thread; key++) {
+    int val = -1;
+    bool even = (key / num_threads) % 2 == 0;
+    EXPECT_EQ(even, test.Find(key, val));
+    if (even) {
+      EXPECT_EQ(key * 2, val);
+    }
+  }
+}
+
+// readers only take shared latches, they run alongside each other and a
+// writer that keeps splitting
+TEST(ExtendibleHashTest, ConcurrentReadTest) {
+  const int num_readers = 8;
+  const int num_keys = 20000;
+  ExtendibleHash<int, int> test(8);
+  for (int key = 0; key < num_keys; key += 2) {
+    test.Insert(key, key);
+  }
+  std::atomic<bool> done(false);
+  std::atomic<int> wrong_finds(0);
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < num_readers; tid++) {
+    readers.push_back(std::thread([tid, &test, &done, &wrong_finds]() {
+      while (!done) {
+        for (int key = tid * 2; key < num_keys; key += num_readers * 2) {
+          int val;
+          if (!test.Find(key, val) || val != key) {
+            wrong_finds++;
+          }
+        }
+      }
+    }));
+  }
+  for (int key = 1; key < num_keys; key += 2) {
+    test.Insert(key, key);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, wrong_finds);
+  for (int key = 0; key < num_keys; key++) {
+    int val;
+    EXPECT_TRUE(test.Find(key, val));
+  }
+}
+
+// keys that share every directory bit still fill whole buckets, and the
+// fingerprints only narrow down which keys get compared
+TEST(ExtendibleHashTest, FingerprintTest) {
+  ExtendibleHash<int, int> test(64);
+  std::vector<int> keys;
+  for (int key = 0; keys.size() < 64; key++) {
+    if ((test.HashKey(key) & 0xff) == 0) {
+      keys.push_back(key);
+    }
+  }
+  for (int key : keys) {
+    test.Insert(key, -key);
+  }
+  // no split below 8 bits was needed to fit them
+  EXPECT_EQ(0, test.GetGlobalDepth());
+  EXPECT_EQ(1, test.GetNumBuckets());
+  for (int key : keys) {
+    int val;
+    EXPECT_TRUE(test.Find(key, val));
+    EXPECT_EQ(-key, val);
   }
+  // the last entry moves into the hole of a removed one
+  EXPECT_TRUE(test.Remove(keys[0]));
+  EXPECT_FALSE(test.Remove(keys[0]));
+  int val;
+  EXPECT_FALSE(test.Find(keys[0], val));
+  EXPECT_TRUE(test.Find(keys.back(), val));
+  EXPECT_EQ(-keys.back(), val);
+  // an existing key is updated in place, even in a full bucket
+  test.Insert(keys[0], 1);
+  test.Insert(keys[0], 2);
+  EXPECT_TRUE(test.Find(keys[0], val));
+  EXPECT_EQ(2, val);
+  EXPECT_EQ(0, test.GetGlobalDepth());
 }
 
 } // namespace cmudb
@@ -0,0 +1,136 @@
+/**
+ * page_table_test.cpp
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "hash/page_table.h"
+
+namespace cmudb {
+
+class PageTableTest : public ::testing::Test {
+protected:
+  static const int num_frames = 16;
+};
+
+TEST_F(PageTableTest, SampleTest) {
+  PageTable page_table(num_frames);
+  EXPECT_LE(2 * num_frames, page_table.GetCapacity());
+
+  for (int i = 0; i < num_frames; ++i) {
+    page_table.Insert(100 + i, i);
+  }
+  frame_id_t frame_id = -1;
+  for (int i = 0; i < num_frames; ++i) {
+    EXPECT_EQ(true, page_table.Find(100 + i, frame_id));
+    EXPECT_EQ(i, frame_id);
+  }
+  EXPECT_EQ(false, page_table.Find(99, frame_id));
+
+  // insert of a mapped page id replaces the frame
+  page_table.Insert(100, 5);
+  EXPECT_EQ(true, page_table.Find(100, frame_id));
+  EXPECT_EQ(5, frame_id);
+
+  EXPECT_EQ(true, page_table.Remove(100));
+  EXPECT_EQ(false, page_table.Remove(100));
+  EXPECT_EQ(false, page_table.Find(100, frame_id));
+  EXPECT_EQ(true, page_table.Find(101, frame_id));
+  EXPECT_EQ(1, frame_id);
+}
+
+// eviction remaps frames over and over, tombstones must not fill the table
+TEST_F(PageTableTest, ChurnTest) {
+  PageTable page_table(num_frames);
+  for (int i = 0; i < num_frames; ++i) {
+    page_table.Insert(i, i);
+  }
+  for (int page_id = num_frames; page_id < 10000; ++page_id) {
+    int frame = page_id % num_frames;
+    EXPECT_EQ(true, page_table.Remove(page_id - num_frames));
+    page_table.Insert(page_id, frame);
+  }
+  frame_id_t frame_id = -1;
+  for (int page_id = 10000 - num_frames; page_id < 10000; ++page_id) {
+    EXPECT_EQ(true, page_table.Find(page_id, frame_id));
+    EXPECT_EQ(page_id % num_frames, frame_id);
+  }
+  EXPECT_EQ(false, page_table.Find(10000 - num_frames - 1, frame_id));
+}
+
+// readers never miss a page that stays mapped while a writer churns the
+// rest of the table, rehashes included
+TEST_F(PageTableTest, ConcurrentTest) {
+  PageTable page_table(num_frames);
+  const int stable = num_frames / 2;
+  for (int i = 0; i < stable; ++i) {
+    page_table.Insert(i, i);
+  }
+
+  std::atomic<bool> done(false);
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 4; ++tid) {
+    readers.push_back(std::thread([&]() {
+      frame_id_t frame_id = -1;
+      while (!done) {
+        for (int i = 0; i < stable; ++i) {
+          EXPECT_EQ(true, page_table.Find(i, frame_id));
+          EXPECT_EQ(i, frame_id);
+        }
+      }
+    }));
+  }
+  for (int page_id = stable; page_id < 50000; ++page_id) {
+    int frame = stable + page_id % (num_frames - stable);
+    if (page_id >= num_frames) {
+      page_table.Remove(page_id - (num_frames - stable));
+    }
+    page_table.Insert(page_id, frame);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+// growing the table keeps every mapping and never makes a reader miss
+TEST_F(PageTableTest, ReserveTest) {
+  PageTable page_table(num_frames);
+  const int stable = num_frames / 2;
+  for (int i = 0; i < stable; ++i) {
+    page_table.Insert(i, i);
+  }
+
+  std::atomic<bool> done(false);
+  std::thread reader([&]() {
+    frame_id_t frame_id = -1;
+    while (!done) {
+      for (int i = 0; i < stable; ++i) {
+        EXPECT_EQ(true, page_table.Find(i, frame_id));
+        EXPECT_EQ(i, frame_id);
+      }
+    }
+  });
+  size_t max_entries = num_frames;
+  for (int round = 0; round < 6; ++round) {
+    max_entries *= 2;
+    page_table.Reserve(max_entries);
+    EXPECT_LE(2 * max_entries, page_table.GetCapacity());
+    for (size_t i = stable; i < max_entries; ++i) {
+      page_table.Insert(i, i);
+    }
+  }
+  done = true;
+  reader.join();
+
+  frame_id_t frame_id = -1;
+  for (size_t i = 0; i < max_entries; ++i) {
+    EXPECT_EQ(true, page_table.Find(i, frame_id));
+    EXPECT_EQ(static_cast<frame_id_t>(i), frame_id);
+  }
+}
+
+} // namespace cmudb
@@ -101,6 +101,41 @@ void DeleteHelperSplit(
   delete transaction;
 }
 
+// helper function to look up keys that must be in the tree, every other
+// thread with a transaction (latched leaf) and without (fully optimistic)
+void LookupHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> &tree,
+                  const std::vector<int64_t> &keys, int rounds,
+                  uint64_t thread_itr = 0) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  Transaction *transaction =
+      (thread_itr % 2 == 0) ? new Transaction(0) : nullptr;
+  for (int round = 0; round < rounds; ++round) {
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.GetValue(index_key, rids, transaction));
+      ASSERT_EQ(rids.size(), 1);
+      EXPECT_EQ(rids[0].GetSlotNum(), key);
+    }
+  }
+  delete transaction;
+}
+
+// helper function to insert without a transaction
+void InsertHelperNoTransaction(
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> &tree,
+    const std::vector<int64_t> &keys,
+    __attribute__((unused)) uint64_t thread_itr = 0) {
+  GenericKey<8> index_key;
+  RID rid;
+  for (auto key : keys) {
+    int64_t value = key & 0xFFFFFFFF;
+    rid.Set((int32_t) (key >> 32), value);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid);
+  }
+}
 
 TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
@@ -428,6 +463,85 @@ TEST(BPlusTreeConcurrentTest, MixTest2) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, OptimisticLookupTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  GenericKey<8> index_key;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+  // first, populate index
+  std::vector<int64_t> keys, new_keys;
+  for (int i = 1; i <= 100; ++i) {
+    keys.push_back(i);
+    new_keys.push_back(i + 100);
+  }
+  InsertHelper(tree, keys);
+
+  // readers must keep finding every old key while splits go on around them
+  std::thread t0(InsertHelper, std::ref(tree), new_keys, 0);
+  LaunchParallelTest(4, LookupHelper, std::ref(tree), std::ref(keys), 20);
+  t0.join();
+
+  LookupHelper(tree, new_keys, 1);
+  std::vector<RID> rids;
+  index_key.SetFromInteger(1000);
+  EXPECT_FALSE(tree.GetValue(index_key, rids));
+  EXPECT_EQ(rids.size(), 0);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+
+// a writer without a transaction latches all the same, so lookups next to
+// it never validate a page it is changing or a root it has not set up yet
+TEST(BPlusTreeConcurrentTest, OptimisticLookupNoTransactionTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+  std::vector<int64_t> keys, new_keys;
+  for (int i = 1; i <= 100; ++i) {
+    keys.push_back(i);
+    new_keys.push_back(i + 100);
+  }
+  InsertHelperNoTransaction(tree, keys);
+  LookupHelper(tree, keys, 1);
+
+  std::thread t0(InsertHelperNoTransaction, std::ref(tree), new_keys, 0);
+  LaunchParallelTest(4, LookupHelper, std::ref(tree), std::ref(keys), 20);
+  t0.join();
+  LookupHelper(tree, new_keys, 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
 
 /*
 TEST(BPlusTreeConcurrentTest, MixTest3) {
@@ -1039,4 +1039,58 @@ TEST(BPlusTreeTests, RandomTestQuick) {
 }
 
 
+TEST(BPlusTreeTests, InternalPagePriorityTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 200; ++key) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  for (int64_t key = 1; key <= 200; ++key) {
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, rids);
+  }
+
+  // the lookups went through every internal page and tagged it, the leaves
+  // stay NORMAL
+  page_id_t end_page_id;
+  bpm->NewPage(end_page_id);
+  bpm->UnpinPage(end_page_id, false);
+  int internal_pages = 0;
+  for (page_id = HEADER_PAGE_ID + 1; page_id < end_page_id; ++page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage()) {
+      EXPECT_EQ(PagePriority::NORMAL, page->GetPriority());
+    } else {
+      EXPECT_EQ(PagePriority::HIGH, page->GetPriority());
+      internal_pages++;
+    }
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_LT(0, internal_pages);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 } // namespace cmudb
@@ -0,0 +1,285 @@
+/**
+ * extendible_hash_index_test.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/extendible_hash_table.h"
+#include "page/header_page.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+using HashIndexTable =
+    ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+
+static void InsertKeys(HashIndexTable &table, int64_t begin, int64_t end) {
+  GenericKey<8> index_key;
+  RID rid;
+  for (int64_t key = begin; key < end; key++) {
+    index_key.SetFromInteger(key);
+    rid.Set((int32_t)(key >> 32), (int32_t)key);
+    EXPECT_TRUE(table.Insert(index_key, rid));
+  }
+}
+
+// the keys that must be there are, those that must not are not
+static void CheckKeys(HashIndexTable &table, int64_t begin, int64_t end,
+                      bool present) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int64_t key = begin; key < end; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(present, table.GetValue(index_key, rids));
+    if (present) {
+      ASSERT_EQ(1, rids.size());
+      EXPECT_EQ(key, rids[0].GetSlotNum());
+    } else {
+      EXPECT_EQ(0, rids.size());
+    }
+  }
+}
+
+TEST(ExtendibleHashIndexTest, InsertRemoveTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = static_cast<HeaderPage *>(bpm->NewPage(page_id));
+  (void)header_page;
+
+  HashIndexTable table("foo_hash", bpm, comparator);
+  // recorded like the root of a b+ tree
+  page_id_t header_page_id;
+  EXPECT_TRUE(header_page->GetRootId("foo_hash", header_page_id));
+  EXPECT_EQ(table.GetHeaderPageId(), header_page_id);
+
+  // many more keys than a bucket holds, and more pages than frames
+  InsertKeys(table, 0, 10000);
+  CheckKeys(table, 0, 10000, true);
+  CheckKeys(table, 10000, 11000, false);
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(42);
+  EXPECT_FALSE(table.Insert(index_key, RID(0, 43)));
+  EXPECT_LT(0, table.GetGlobalDepth(table.Hash(index_key)));
+
+  for (int64_t key = 0; key < 10000; key += 2) {
+    index_key.SetFromInteger(key);
+    table.Remove(index_key);
+  }
+  for (int64_t key = 0; key < 10000; key++) {
+    std::vector<RID> rids;
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key % 2 == 1, table.GetValue(index_key, rids));
+  }
+  // a removed key can come back
+  InsertKeys(table, 0, 1);
+  CheckKeys(table, 0, 2, true);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(ExtendibleHashIndexTest, PersistTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+
+  {
+    HashIndexTable table("foo_hash", bpm, comparator);
+    InsertKeys(table, 0, 5000);
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+  delete disk_manager;
+
+  // the directories and buckets are found again from the header page
+  disk_manager = new DiskManager("test.db");
+  bpm = new BufferPoolManager(50, disk_manager);
+  auto header_page = static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  page_id_t header_page_id;
+  EXPECT_TRUE(header_page->GetRootId("foo_hash", header_page_id));
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+  HashIndexTable table("foo_hash", bpm, comparator, header_page_id);
+  CheckKeys(table, 0, 5000, true);
+  CheckKeys(table, 5000, 6000, false);
+
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+// a table whose pages the pool has no frame for throws instead of reading
+// an empty guard
+TEST(ExtendibleHashIndexTest, PoolExhaustedTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+
+  HashIndexTable table("foo_hash", bpm, comparator);
+  InsertKeys(table, 0, 100);
+  // every frame pinned by somebody else
+  std::vector<page_id_t> pinned;
+  while (bpm->NewPage(page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(0);
+  std::vector<RID> rids;
+  EXPECT_THROW(table.GetValue(index_key, rids), std::bad_alloc);
+  EXPECT_THROW(table.Insert(index_key, RID(0, 0)), std::bad_alloc);
+  EXPECT_THROW(table.Remove(index_key), std::bad_alloc);
+
+  for (auto pinned_page_id : pinned) {
+    bpm->UnpinPage(pinned_page_id, false);
+  }
+  CheckKeys(table, 0, 100, true);
+
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+// keys that compare equal are the same key, whatever their bytes
+TEST(ExtendibleHashIndexTest, EqualKeysTest) {
+  Schema *key_schema = ParseCreateStatement("a double");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+
+  HashIndexTable table("foo_hash", bpm, comparator);
+  GenericKey<8> zero, negative_zero;
+  zero.SetFromKey(Tuple({Value(TypeId::DECIMAL, 0.0)}, key_schema));
+  negative_zero.SetFromKey(Tuple({Value(TypeId::DECIMAL, -0.0)}, key_schema));
+  ASSERT_NE(0, memcmp(zero.data, negative_zero.data, sizeof(zero.data)));
+  EXPECT_EQ(0, comparator(zero, negative_zero));
+  EXPECT_EQ(table.Hash(zero), table.Hash(negative_zero));
+
+  EXPECT_TRUE(table.Insert(zero, RID(0, 1)));
+  EXPECT_FALSE(table.Insert(negative_zero, RID(0, 2)));
+  std::vector<RID> rids;
+  EXPECT_TRUE(table.GetValue(negative_zero, rids));
+  ASSERT_EQ(1, rids.size());
+  EXPECT_EQ(RID(0, 1), rids[0]);
+  table.Remove(negative_zero);
+  rids.clear();
+  EXPECT_FALSE(table.GetValue(zero, rids));
+
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(ExtendibleHashIndexTest, ConcurrentInsertTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+
+  HashIndexTable table("foo_hash", bpm, comparator);
+  // each thread inserts its own keys and looks up those of the others
+  std::vector<std::thread> threads;
+  for (int64_t tid = 0; tid < 8; tid++) {
+    threads.emplace_back([&table, tid]() {
+      InsertKeys(table, tid * 1000, (tid + 1) * 1000);
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int64_t key = 0; key < 8000; key++) {
+        index_key.SetFromInteger(key);
+        table.GetValue(index_key, rids);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  CheckKeys(table, 0, 8000, true);
+
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(ExtendibleHashIndexTest, IndexTest) {
+  Schema *schema = ParseCreateStatement("a int, b varchar(13)");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+
+  // a B+ tree unless the index method says otherwise
+  std::string sql = "foo_pk a";
+  IndexMetadata *metadata = ParseIndexStatement(sql, "foo", schema);
+  EXPECT_EQ(IndexType::BPLUSTREE, metadata->GetIndexType());
+  delete metadata;
+  sql = "foo_hash USING HASH b, a";
+  metadata = ParseIndexStatement(sql, "foo", schema);
+  EXPECT_EQ(IndexType::HASH, metadata->GetIndexType());
+  EXPECT_EQ(2, metadata->GetIndexColumnCount());
+  Index *index = ConstructIndex(metadata, bpm);
+
+  std::vector<Tuple> keys;
+  for (int32_t i = 0; i < 200; i++) {
+    std::vector<Value> values{
+        Value(TypeId::VARCHAR, "key" + std::to_string(i)),
+        Value(TypeId::INTEGER, i)};
+    keys.emplace_back(values, index->GetKeySchema());
+    index->InsertEntry(keys.back(), RID(i, i));
+  }
+  std::vector<RID> rids;
+  for (int32_t i = 0; i < 200; i++) {
+    rids.clear();
+    index->ScanKey(keys[i], rids);
+    ASSERT_EQ(1, rids.size());
+    EXPECT_EQ(RID(i, i), rids[0]);
+  }
+  index->DeleteEntry(keys[7]);
+  rids.clear();
+  index->ScanKey(keys[7], rids);
+  EXPECT_EQ(0, rids.size());
+
+  delete index;
+  delete bpm;
+  delete disk_manager;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
@@ -48,7 +48,7 @@ TEST(LogManagerTest, BasicLogging) {
   LOG_DEBUG("Turning off flushing thread");
 
   // some basic manually checking here
-  char buffer[PAGE_SIZE];
+  char buffer[MAX_PAGE_SIZE];
   storage_engine->disk_manager_->ReadLog(buffer, PAGE_SIZE, 0);
   int32_t size = *reinterpret_cast<int32_t *>(buffer);
   LOG_DEBUG("size  = %d", size);
@@ -113,7 +113,7 @@ TEST(LogManagerTest, RedoTestWithOneTxn) {
   storage_engine = new StorageEngine("test.db");
 
   // some basic manually checking here
-  char buffer[PAGE_SIZE];
+  char buffer[MAX_PAGE_SIZE];
   storage_engine->disk_manager_->ReadLog(buffer, PAGE_SIZE, 0);
   int32_t size = *reinterpret_cast<int32_t *>(buffer);
   LOG_DEBUG("check begin size  = %d", size);
@@ -291,4 +291,24 @@ TEST(LogManagerTest, RedoDeleteTest) {
   remove("test.log");
 }
 
+// a page write waits for the log by sleeping on the log manager, and does
+// not wait at all while logging is off
+TEST(LogManagerTest, WaitForPersistentLSNTest) {
+  StorageEngine *storage_engine = new StorageEngine("test.db");
+  storage_engine->log_manager_->WaitForPersistentLSN(1000);
+
+  storage_engine->log_manager_->RunFlushThread();
+  Transaction *txn = storage_engine->transaction_manager_->Begin();
+  storage_engine->transaction_manager_->Commit(txn);
+  storage_engine->log_manager_->WaitForPersistentLSN(txn->GetPrevLSN());
+  EXPECT_LE(txn->GetPrevLSN(),
+            storage_engine->log_manager_->GetPersistentLSN());
+
+  delete txn;
+  delete storage_engine;
+  EXPECT_FALSE(ENABLE_LOGGING);
+  remove("test.db");
+  remove("test.log");
+}
+
 } // namespace cmudb
@@ -1,16 +1,17 @@
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 #include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
 #include "page/header_page.h"
 #include "gtest/gtest.h"
 
-// NOTE: when you running this test, make sure page size(config.h) is at least
-// 4096
 namespace cmudb {
 
 TEST(HeaderPageTest, UnitTest) {
-  DiskManager *disk_manager = new DiskManager("test.db");
+  // 27 records need a page of at least 1K
+  DiskManager *disk_manager = new DiskManager("test.db", 4096);
   BufferPoolManager *buffer_pool_manager =
       new BufferPoolManager(20, disk_manager);
   page_id_t header_page_id;
@@ -55,4 +56,89 @@ TEST(HeaderPageTest, UnitTest) {
   remove("test.db");
   remove("test.log");
 }
+
+// the page size chosen at creation is recorded in the header page and wins
+// over the one asked for when the file is opened again
+TEST(HeaderPageTest, PageSizeTest) {
+  DiskManager *disk_manager = new DiskManager("test.db", 8192);
+  EXPECT_EQ(8192, PAGE_SIZE);
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(20, disk_manager);
+  page_id_t header_page_id;
+  HeaderPage *page =
+      static_cast<HeaderPage *>(buffer_pool_manager->NewPage(header_page_id));
+  ASSERT_NE(nullptr, page);
+  page->Init();
+  EXPECT_EQ(8192, page->GetPageSize());
+  // (8192 - 20) / 36 records fit
+  for (int i = 0; i < 227; i++) {
+    EXPECT_EQ(true, page->InsertRecord(std::to_string(i), i + 1));
+  }
+  EXPECT_EQ(false, page->InsertRecord("full", 1));
+  page_id_t last_page_id;
+  EXPECT_NE(nullptr, buffer_pool_manager->NewPage(last_page_id));
+  strcpy(buffer_pool_manager->FetchPage(last_page_id)->GetData() + 8000,
+         "end of page");
+  EXPECT_EQ(true, buffer_pool_manager->UnpinPage(last_page_id, true));
+  EXPECT_EQ(true, buffer_pool_manager->UnpinPage(last_page_id, true));
+  EXPECT_EQ(true, buffer_pool_manager->UnpinPage(header_page_id, true));
+  EXPECT_EQ(2, buffer_pool_manager->FlushAllPages());
+  delete buffer_pool_manager;
+  delete disk_manager;
+
+  disk_manager = new DiskManager("test.db", 512);
+  EXPECT_EQ(8192, PAGE_SIZE);
+  buffer_pool_manager = new BufferPoolManager(20, disk_manager);
+  page = static_cast<HeaderPage *>(
+      buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(227, page->GetRecordCount());
+  page_id_t root_id;
+  EXPECT_EQ(true, page->GetRootId("226", root_id));
+  EXPECT_EQ(227, root_id);
+  EXPECT_EQ(0, strcmp(buffer_pool_manager->FetchPage(last_page_id)->GetData() +
+                          8000,
+                      "end of page"));
+
+  delete buffer_pool_manager;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// one page size per process: a second open database must agree with the
+// first, and a header page of another format version is refused
+TEST(HeaderPageTest, FormatTest) {
+  EXPECT_THROW(DiskManager("test.db", 1000), Exception);
+  DiskManager *disk_manager = new DiskManager("test.db", 4096);
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(20, disk_manager);
+  page_id_t header_page_id;
+  HeaderPage *page =
+      static_cast<HeaderPage *>(buffer_pool_manager->NewPage(header_page_id));
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(false, page->IsCurrentFormat());
+  page->Init();
+  EXPECT_EQ(true, page->IsCurrentFormat());
+  EXPECT_THROW(DiskManager("other.db", 8192), Exception);
+  EXPECT_EQ(4096, PAGE_SIZE);
+  {
+    DiskManager same_size("other.db", 4096);
+  }
+  remove("other.db");
+  remove("other.log");
+
+  // written by a later version
+  int version = HEADER_PAGE_VERSION + 1;
+  memcpy(page->GetData() + HEADER_PAGE_VERSION_OFFSET, &version, 4);
+  EXPECT_EQ(false, page->IsCurrentFormat());
+  EXPECT_EQ(true, buffer_pool_manager->UnpinPage(header_page_id, true));
+  EXPECT_EQ(1, buffer_pool_manager->FlushAllPages());
+  delete buffer_pool_manager;
+  delete disk_manager;
+  EXPECT_THROW(DiskManager("test.db", 4096), Exception);
+
+  remove("test.db");
+  remove("test.log");
+}
 } // namespace cmudb
@@ -0,0 +1,98 @@
+/**
+ * mapped_scan_test.cpp
+ */
+
+#include <cstdio>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "table/table_heap.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+static Tuple IntTuple(Schema *schema, int32_t value) {
+  std::vector<Value> values{Value(TypeId::INTEGER, value)};
+  return Tuple(values, schema);
+}
+
+// sum of column a over a scan, and the number of tuples
+static int64_t Sum(Schema *schema, TableIterator &&itr, TableHeap *table,
+                   int &count) {
+  int64_t sum = 0;
+  count = 0;
+  for (; itr != table->end(); ++itr) {
+    sum += itr->GetValue(schema, 0).GetAs<int32_t>();
+    count++;
+  }
+  return sum;
+}
+
+TEST(MappedScanTest, SampleTest) {
+  Schema *schema = new Schema({Column(TypeId::INTEGER, 4, "a")});
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(10, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  // many more pages than frames
+  RID rid;
+  std::vector<RID> rids;
+  int64_t expected_sum = 0;
+  for (int32_t i = 0; i < 2000; ++i) {
+    EXPECT_TRUE(table->InsertTuple(IntTuple(schema, i), rid, transaction));
+    rids.push_back(rid);
+    expected_sum += i;
+  }
+  EXPECT_GT(rids.back().GetPageId(), 20);
+  buffer_pool_manager->FlushAllPages();
+
+  // only the first page and the pages the pool still has come from the pool
+  buffer_pool_manager->ResetStats();
+  int disk_reads = disk_manager->GetNumReads();
+  int count;
+  EXPECT_EQ(expected_sum,
+            Sum(schema, table->MappedBegin(transaction), table, count));
+  EXPECT_EQ(2000, count);
+  EXPECT_GE(1u, buffer_pool_manager->GetStats().misses);
+  EXPECT_GE(disk_reads + 1, disk_manager->GetNumReads());
+
+  // a scan through the pool reads most pages
+  disk_reads = disk_manager->GetNumReads();
+  EXPECT_EQ(expected_sum,
+            Sum(schema, table->begin(transaction), table, count));
+  EXPECT_LT(disk_reads + 10, disk_manager->GetNumReads());
+
+  // a page changed in the pool is newer than the file, and a page the file
+  // only got after the mapping was made is not in it
+  EXPECT_TRUE(
+      table->UpdateTuple(IntTuple(schema, 100000), rids[0], transaction));
+  EXPECT_TRUE(table->InsertTuple(IntTuple(schema, 7), rid, transaction));
+  // in place of 0
+  expected_sum += 100000 + 7;
+  TableIterator itr = table->MappedBegin(transaction);
+  for (int32_t i = 0; i < 2000; ++i) {
+    EXPECT_TRUE(
+        table->InsertTuple(IntTuple(schema, i), rid, transaction));
+    expected_sum += i;
+  }
+  EXPECT_EQ(expected_sum, Sum(schema, std::move(itr), table, count));
+  EXPECT_EQ(4001, count);
+
+  delete table;
+  delete buffer_pool_manager;
+  delete log_manager;
+  delete lock_manager;
+  delete disk_manager;
+  delete transaction;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
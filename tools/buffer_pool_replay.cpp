@@ -0,0 +1,71 @@
+/**
+ * buffer_pool_replay.cpp
+ *
+ * Replay a buffer pool trace (BufferPoolManager::StartTrace) against a pool
+ * of a given size and replacement policy, and report how it did:
+ *
+ *   buffer_pool_replay <trace file> <pool size> [lru|clock|lru_k|arc] [k]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+
+#include "buffer/trace_replayer.h"
+
+using namespace cmudb;
+
+static bool ParseReplacer(const char *name, ReplacerType &replacer_type) {
+  if (strcmp(name, "lru") == 0) {
+    replacer_type = ReplacerType::LRU;
+  } else if (strcmp(name, "clock") == 0) {
+    replacer_type = ReplacerType::CLOCK;
+  } else if (strcmp(name, "lru_k") == 0) {
+    replacer_type = ReplacerType::LRU_K;
+  } else if (strcmp(name, "arc") == 0) {
+    replacer_type = ReplacerType::ARC;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  ReplacerType replacer_type = ReplacerType::LRU;
+  long pool_size = argc >= 3 ? atol(argv[2]) : 0;
+  long replacer_k = argc >= 5 ? atol(argv[4]) : LRUK_REPLACER_K;
+  if (argc < 3 || argc > 5 || pool_size <= 0 || replacer_k <= 0 ||
+      (argc >= 4 && !ParseReplacer(argv[3], replacer_type))) {
+    fprintf(stderr, "usage: %s <trace file> <pool size> "
+                    "[lru|clock|lru_k|arc] [k]\n",
+            argv[0]);
+    return 1;
+  }
+
+  std::vector<TraceRecord> records;
+  if (!BufferPoolTrace::Read(argv[1], records)) {
+    fprintf(stderr, "%s is not a buffer pool trace\n", argv[1]);
+    return 1;
+  }
+  std::set<uint16_t> threads;
+  for (const auto &record : records) {
+    threads.insert(record.thread_);
+  }
+
+  TraceReplayer replayer(pool_size, replacer_type, replacer_k);
+  ReplayResult result = replayer.Replay(records);
+
+  printf("calls:          %zu from %zu threads\n", records.size(),
+         threads.size());
+  printf("hits:           %llu\n",
+         static_cast<unsigned long long>(result.stats_.hits));
+  printf("misses:         %llu\n",
+         static_cast<unsigned long long>(result.stats_.misses));
+  printf("hit ratio:      %.4f\n", result.stats_.HitRatio());
+  printf("pages read:     %d\n", result.disk_reads_);
+  printf("write requests: %d\n", result.disk_write_requests_);
+  printf("failed calls:   %zu\n", result.failed_calls_);
+  printf("wall time:      %.3f s\n", result.seconds_);
+  return 0;
+}